@@ -0,0 +1,365 @@
+#ifndef CLONG_COMPILATIONCACHE_HPP
+#define CLONG_COMPILATIONCACHE_HPP
+
+#include <clong/config.hpp>
+#include <clong/clang.hpp>
+#include <clong/hash.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clong {
+
+/// Binary cache of a `compile_commands.json`, memory-mapped and usable without any parsing
+///
+/// Layout (native endianness, every section is 8 bytes aligned):
+/// - `Header`
+/// - `Entry[entry_count]`, one per compile command
+/// - `uint32_t[arg_count]`, arguments of all commands (string ids)
+/// - `uint32_t[bucket_count]`, open addressing hash table on file names (entry index + 1, 0 if
+///   empty), so looking up the commands of one file is O(1)
+/// - `String[string_count]`, interned strings (offset and size in the blob)
+/// - blob of string characters
+///
+/// The cache is invalidated when the size or modification time of the JSON changes, and every
+/// section and index is checked to be within the file when loaded.
+class CompilationCache : public clang::tooling::CompilationDatabase {
+  static constexpr std::uint64_t version = 2;
+
+  static const char* magic() {
+    return "CLONGCDB";
+  }
+
+  struct Header {
+    char magic[8];
+    std::uint64_t version;
+    std::uint64_t json_size;
+    std::int64_t json_mtime;
+    std::uint64_t entry_count;
+    std::uint64_t entries_offset;
+    std::uint64_t arg_count;
+    std::uint64_t args_offset;
+    std::uint64_t bucket_count;
+    std::uint64_t buckets_offset;
+    std::uint64_t string_count;
+    std::uint64_t strings_offset;
+    std::uint64_t blob_offset;
+  };
+
+  struct Entry {
+    std::uint64_t hash;
+    std::uint64_t args_begin;
+    std::uint32_t args_count;
+    std::uint32_t file;
+    std::uint32_t directory;
+    std::uint32_t output;
+  };
+
+  struct String {
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  std::unique_ptr<llvm::MemoryBuffer> m_buffer;
+  Header m_header;
+  const Entry* m_entries;
+  const std::uint32_t* m_args;
+  const std::uint32_t* m_buckets;
+  const String* m_strings;
+  const char* m_blob;
+
+  private:
+  CompilationCache(std::unique_ptr<llvm::MemoryBuffer> buffer, Header const& header)
+    : m_buffer(std::move(buffer)), m_header(header) {
+    auto* data = m_buffer->getBufferStart();
+    m_entries = reinterpret_cast<const Entry*>(data + header.entries_offset);
+    m_args = reinterpret_cast<const std::uint32_t*>(data + header.args_offset);
+    m_buckets = reinterpret_cast<const std::uint32_t*>(data + header.buckets_offset);
+    m_strings = reinterpret_cast<const String*>(data + header.strings_offset);
+    m_blob = data + header.blob_offset;
+  }
+
+  llvm::StringRef string(std::uint32_t id) const {
+    auto const& s = m_strings[id];
+    return llvm::StringRef(m_blob + s.offset, s.size);
+  }
+
+  clang::tooling::CompileCommand command(Entry const& entry) const {
+    std::vector<std::string> args;
+    args.reserve(entry.args_count);
+    for (std::uint32_t i = 0; i < entry.args_count; ++i) {
+      args.push_back(string(m_args[entry.args_begin + i]));
+    }
+    return clang::tooling::CompileCommand(string(entry.directory), string(entry.file),
+        std::move(args), string(entry.output));
+  }
+
+  static std::uint64_t align(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t(7);
+  }
+
+  /// Absolute path without `.` and `..`, the key of the hash table
+  static std::string normalize(llvm::StringRef directory, llvm::StringRef file) {
+    llvm::SmallString<256> path(file);
+    if (!llvm::sys::path::is_absolute(path)) {
+      if (directory.empty()) {
+        llvm::sys::fs::make_absolute(path);
+      } else {
+        llvm::sys::fs::make_absolute(directory, path);
+      }
+    }
+    llvm::sys::path::remove_dots(path, true);
+    llvm::sys::path::native(path);
+    return path.str();
+  }
+
+  static bool file_info(std::string const& path, std::uint64_t& size, std::int64_t& mtime) {
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(path, status)) {
+      return false;
+    }
+    size = status.getSize();
+    mtime = status.getLastModificationTime().time_since_epoch().count();
+    return true;
+  }
+
+  /// True if all the sections, and the indices they contain, are within the `size` bytes of `data`
+  static bool check(Header const& h, const char* data, std::uint64_t size) {
+    auto fits = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t elem_size) {
+      return offset <= size && offset % 8 == 0 && count <= (size - offset) / elem_size;
+    };
+    // Lookups stop on an empty bucket, so the table cannot be full
+    if (!fits(h.entries_offset, h.entry_count, sizeof(Entry))
+        || !fits(h.args_offset, h.arg_count, sizeof(std::uint32_t))
+        || !h.bucket_count || (h.bucket_count & (h.bucket_count - 1))
+        || h.entry_count >= h.bucket_count
+        || !fits(h.buckets_offset, h.bucket_count, sizeof(std::uint32_t))
+        || !fits(h.strings_offset, h.string_count, sizeof(String))
+        || h.blob_offset > size) {
+      return false;
+    }
+    auto blob_size = size - h.blob_offset;
+    auto* strings = reinterpret_cast<const String*>(data + h.strings_offset);
+    for (std::uint64_t i = 0; i < h.string_count; ++i) {
+      if (strings[i].offset > blob_size || strings[i].size > blob_size - strings[i].offset) {
+        return false;
+      }
+    }
+    auto* args = reinterpret_cast<const std::uint32_t*>(data + h.args_offset);
+    for (std::uint64_t i = 0; i < h.arg_count; ++i) {
+      if (args[i] >= h.string_count) {
+        return false;
+      }
+    }
+    auto* entries = reinterpret_cast<const Entry*>(data + h.entries_offset);
+    for (std::uint64_t i = 0; i < h.entry_count; ++i) {
+      auto const& e = entries[i];
+      if (e.file >= h.string_count || e.directory >= h.string_count
+          || e.output >= h.string_count || e.args_begin > h.arg_count
+          || e.args_count > h.arg_count - e.args_begin) {
+        return false;
+      }
+    }
+    auto* buckets = reinterpret_cast<const std::uint32_t*>(data + h.buckets_offset);
+    for (std::uint64_t i = 0; i < h.bucket_count; ++i) {
+      if (buckets[i] > h.entry_count) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  public:
+  /// Load a cache, returns null if missing, invalid or stale
+  static std::unique_ptr<CompilationCache> load(std::string const& path,
+      std::uint64_t json_size, std::int64_t json_mtime) {
+#if CLANG_VERSION_MAJOR >= 13
+    auto buffer = llvm::MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+#else
+    auto buffer = llvm::MemoryBuffer::getFile(path, -1, /* RequiresNullTerminator */ false);
+#endif
+    if (!buffer) {
+      return nullptr;
+    }
+    auto size = (*buffer)->getBufferSize();
+    if (size < sizeof(Header)) {
+      return nullptr;
+    }
+    Header header;
+    std::memcpy(&header, (*buffer)->getBufferStart(), sizeof(Header));
+    if (std::memcmp(header.magic, magic(), sizeof(header.magic)) || header.version != version
+        || header.json_size != json_size || header.json_mtime != json_mtime
+        || !check(header, (*buffer)->getBufferStart(), size)) {
+      return nullptr;
+    }
+    return std::unique_ptr<CompilationCache>(new CompilationCache(std::move(*buffer), header));
+  }
+
+  /// Write the cache of `db` (atomically, using a temporary file)
+  static bool build(std::string const& path, clang::tooling::CompilationDatabase const& db,
+      std::uint64_t json_size, std::int64_t json_mtime) {
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> args;
+    std::vector<String> strings;
+    std::string blob;
+    std::unordered_map<std::string, std::uint32_t> interned;
+    auto intern = [&](std::string const& s) {
+      auto it = interned.find(s);
+      if (it != interned.end()) {
+        return it->second;
+      }
+      auto id = static_cast<std::uint32_t>(strings.size());
+      strings.push_back({blob.size(), s.size()});
+      blob += s;
+      interned.emplace(s, id);
+      return id;
+    };
+    for (auto const& cmd : db.getAllCompileCommands()) {
+      auto file = normalize(cmd.Directory, cmd.Filename);
+      Entry entry;
+      entry.hash = hash::fnv1a(file);
+      entry.args_begin = args.size();
+      entry.args_count = static_cast<std::uint32_t>(cmd.CommandLine.size());
+      entry.file = intern(file);
+      entry.directory = intern(cmd.Directory);
+      entry.output = intern(cmd.Output);
+      for (auto const& arg : cmd.CommandLine) {
+        args.push_back(intern(arg));
+      }
+      entries.push_back(entry);
+    }
+    // Keep the hash table at most half full (power of two, so probing is a mask)
+    std::uint64_t bucket_count = 16;
+    while (bucket_count < 2 * entries.size()) {
+      bucket_count *= 2;
+    }
+    std::vector<std::uint32_t> buckets(bucket_count, 0);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      auto b = entries[i].hash & (bucket_count - 1);
+      while (buckets[b]) {
+        b = (b + 1) & (bucket_count - 1);
+      }
+      buckets[b] = static_cast<std::uint32_t>(i + 1);
+    }
+    // Header
+    Header header;
+    std::memcpy(header.magic, magic(), sizeof(header.magic));
+    header.version = version;
+    header.json_size = json_size;
+    header.json_mtime = json_mtime;
+    header.entry_count = entries.size();
+    header.entries_offset = align(sizeof(Header));
+    header.arg_count = args.size();
+    header.args_offset = align(header.entries_offset + entries.size() * sizeof(Entry));
+    header.bucket_count = bucket_count;
+    header.buckets_offset = align(header.args_offset + args.size() * sizeof(std::uint32_t));
+    header.string_count = strings.size();
+    header.strings_offset = align(header.buckets_offset + buckets.size() * sizeof(std::uint32_t));
+    header.blob_offset = align(header.strings_offset + strings.size() * sizeof(String));
+    // Write everything at once
+    std::string out(header.blob_offset + blob.size(), '\0');
+    auto put = [&](std::uint64_t offset, const void* data, std::size_t size) {
+      if (size) {
+        std::memcpy(&out[offset], data, size);
+      }
+    };
+    put(0, &header, sizeof(Header));
+    put(header.entries_offset, entries.data(), entries.size() * sizeof(Entry));
+    put(header.args_offset, args.data(), args.size() * sizeof(std::uint32_t));
+    put(header.buckets_offset, buckets.data(), buckets.size() * sizeof(std::uint32_t));
+    put(header.strings_offset, strings.data(), strings.size() * sizeof(String));
+    put(header.blob_offset, blob.data(), blob.size());
+    auto tmp = path + ".tmp";
+    {
+      std::ofstream o(tmp, std::ofstream::out | std::ofstream::binary);
+      o.write(out.data(), out.size());
+      if (!o) {
+        return false;
+      }
+    }
+    return !llvm::sys::fs::rename(tmp, path);
+  }
+
+  /// Wrap `db` like clang's JSON compilation database plugin does: response files are expanded,
+  /// commands of files missing from the database (e.g. headers) are inferred from similar files,
+  /// and the target and driver mode are inferred from the compiler name
+  static std::unique_ptr<clang::tooling::CompilationDatabase> wrap(
+      std::unique_ptr<clang::tooling::CompilationDatabase> db) {
+#if CLANG_VERSION_MAJOR >= 10
+    db = clang::tooling::expandResponseFiles(std::move(db), llvm::vfs::getRealFileSystem());
+#endif
+#if CLANG_VERSION_MAJOR >= 7
+    db = clang::tooling::inferMissingCompileCommands(std::move(db));
+#endif
+#if CLANG_VERSION_MAJOR >= 9
+    db = clang::tooling::inferTargetAndDriverMode(std::move(db));
+#endif
+    return db;
+  }
+
+  /// Load the database of `json_path` from its cache, or parse it and (re)build its cache
+  ///
+  /// The cache holds the commands of the JSON as is, the returned database is wrapped (see `wrap`).
+  static std::unique_ptr<clang::tooling::CompilationDatabase> load_or_build(
+      std::string const& json_path, std::string& error) {
+    std::uint64_t size;
+    std::int64_t mtime;
+    if (!file_info(json_path, size, mtime)) {
+      error = "unable to stat " + json_path;
+      return nullptr;
+    }
+    auto cache_path = json_path + ".clong-cache";
+    if (auto cache = load(cache_path, size, mtime)) {
+      return wrap(std::move(cache));
+    }
+    auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+        json_path, error, clang::tooling::JSONCommandLineSyntax::AutoDetect);
+    if (!db) {
+      return nullptr;
+    }
+    if (!build(cache_path, *db, size, mtime)) {
+      CLONG_LOG(debug, "unable to write compilation database cache: " + cache_path);
+    }
+    return wrap(std::move(db));
+  }
+
+  public:
+  virtual std::vector<clang::tooling::CompileCommand> getCompileCommands(
+      llvm::StringRef file_path) const override {
+    std::vector<clang::tooling::CompileCommand> commands;
+    auto file = normalize("", file_path);
+    auto h = hash::fnv1a(file);
+    auto mask = m_header.bucket_count - 1;
+    for (auto b = h & mask; m_buckets[b]; b = (b + 1) & mask) {
+      auto const& entry = m_entries[m_buckets[b] - 1];
+      if (entry.hash == h && string(entry.file) == file) {
+        commands.push_back(command(entry));
+      }
+    }
+    return commands;
+  }
+
+  virtual std::vector<std::string> getAllFiles() const override {
+    std::vector<std::string> files;
+    for (std::uint64_t i = 0; i < m_header.entry_count; ++i) {
+      files.push_back(string(m_entries[i].file));
+    }
+    return files;
+  }
+
+  virtual std::vector<clang::tooling::CompileCommand> getAllCompileCommands() const override {
+    std::vector<clang::tooling::CompileCommand> commands;
+    for (std::uint64_t i = 0; i < m_header.entry_count; ++i) {
+      commands.push_back(command(m_entries[i]));
+    }
+    return commands;
+  }
+};
+
+}
+
+#endif
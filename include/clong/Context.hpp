@@ -4,22 +4,89 @@
 #include <clong/config.hpp>
 #include <clong/Node.hpp>
 #include <clong/PrettyPrinter.hpp>
+#include <clong/Segment.hpp>
+#include <clong/Stats.hpp>
 #include <unordered_set>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace clong {
 
 /// Represents a documentation parsed context (with all parsed nodes)
 class Context {
   RootNode m_root;
-  std::unordered_map<const clang::Decl*, std::unique_ptr<Node>> m_decl2node;
+  std::vector<std::unique_ptr<Node>> m_nodes;
+  // Declarations of the current translation unit (see `end_translation_unit`)
+  std::unordered_map<const clang::Decl*, Node*> m_decl2node;
   std::unordered_set<const clang::Decl*> m_visited;
   std::unordered_set<const Node*> m_functions;
+  std::unordered_set<const Node*> m_records;
+  // Translation units might be processed concurrently
+  std::mutex m_mutex;
+  Stats m_stats;
+  // Bounded-memory mode: comments are spilled to `m_segment` when reaching `m_max_memory`
+  std::size_t m_max_memory = 0;
+  std::size_t m_memory = 0;
+  std::unique_ptr<Segment> m_segment;
+  std::vector<Node*> m_resident;
+  bool m_over_budget = false;
+
+  /// Rough memory cost of a node, and of a decl entry (hash tables entries included)
+  static constexpr std::size_t node_memory = sizeof(Node) + 4 * sizeof(void*);
+  static constexpr std::size_t decl_memory = 4 * sizeof(void*);
+
+  private:
+  void account_memory(std::size_t memory) {
+    m_memory += memory;
+    if (m_max_memory && m_memory > m_max_memory && !m_resident.empty()) {
+      spill();
+    }
+  }
 
   public:
   const RootNode& root() const { return m_root; }
   const std::unordered_set<const Node*>& functions() const { return m_functions; }
+  const std::unordered_set<const Node*>& records() const { return m_records; }
+  std::mutex& mutex() { return m_mutex; }
+  Stats& stats() { return m_stats; }
+  Stats const& stats() const { return m_stats; }
+  std::size_t memory() const { return m_memory; }
+
+  /// Enable bounded-memory mode (`max_memory` is in bytes, 0 means unlimited)
+  void set_max_memory(std::size_t max_memory) {
+    m_max_memory = max_memory;
+  }
+
+  /// Move comments of all registered nodes to disk, leaving only handles in memory
+  void spill() {
+    if (!m_segment) {
+      m_segment = std::make_unique<Segment>();
+    }
+    for (auto* node : m_resident) {
+      m_memory -= node->comment.capacity();
+      node->comment_handle = m_segment->append(node->comment);
+      node->segment = m_segment.get();
+      std::string().swap(node->comment);
+    }
+    m_resident.clear();
+    CLONG_LOG(debug, format("spilled comments, {} bytes on disk", m_segment->size()));
+    if (m_max_memory && m_memory > m_max_memory && !m_over_budget) {
+      m_over_budget = true;
+      CLONG_LOG(warn, format("memory budget exceeded by documentation tree itself ({} bytes)", m_memory));
+    }
+  }
+
+  /// Forget declarations of the current translation unit, registered nodes are kept
+  ///
+  /// Must be called once a translation unit has been traversed: its declarations are freed with
+  /// its AST, and their addresses might be reused by the next ones.
+  void end_translation_unit() {
+    m_memory -= decl_memory * (m_visited.size() + m_decl2node.size());
+    decltype(m_visited)().swap(m_visited);
+    decltype(m_decl2node)().swap(m_decl2node);
+  }
 
   public:
   clang::comments::FullComment* comments_of(const clang::Decl* decl) const {
@@ -41,30 +108,45 @@ class Context {
 
   void mark_as_visited(const clang::Decl* decl) {
     CLONG_LOG(debug, log::colored(decl));
-    m_visited.insert(decl);
+    if (m_visited.insert(decl).second) {
+      account_memory(decl_memory);
+    }
   }
 
   Node* register_node(const clang::Decl* decl, bool allow_no_comments = false) {
     // If there is a visited and  registered node, returns it directly!
     if (has_been_visited_and_registered(decl)) {
-      return m_decl2node[decl].get();
+      return m_decl2node[decl];
     }
     // Visit
     mark_as_visited(decl);
     // Extract comment if any, if none, we're not gonna register this node!
     auto comment = PrettyPrinter::pprint_comments(comments_of(decl));
+    Stats::count(m_stats.comment_bytes, comment.size());
     if (allow_no_comments || comment.size()) {
+      Stats::count(m_stats.registered);
+      if (comment.empty()) {
+        Stats::count(m_stats.auto_registered_parents);
+      }
       // Register
       CLONG_LOG(debug, log::colored(decl));
-      m_decl2node.emplace(decl, std::move(std::make_unique<Node>()));
-      auto* node = m_decl2node[decl].get();
+      m_nodes.push_back(std::make_unique<Node>());
+      auto* node = m_nodes.back().get();
+      m_decl2node.emplace(decl, node);
       // Update node infos
       node->decl = decl;
       node->comment = comment;
+      node->signature = PrettyPrinter::pprint(decl);
+      node->kind = decl->getDeclKindName();
+      if (auto* named_decl = clang::dyn_cast<clang::NamedDecl>(decl)) {
+        node->name = named_decl->getNameAsString();
+        node->qualified_name = named_decl->getQualifiedNameAsString();
+      }
       // Walk visited parents and set relationships
       auto* walking_decl = decl;
       auto& ast_ctxt = decl->getASTContext();
-      while (true) {
+      std::size_t depth = 0;
+      for (;; ++depth) {
         const auto& parents = ast_ctxt.getParents(*walking_decl);
         // If no parents or the first parent decl is null, then we're done 
         if (parents.empty() || !(walking_decl = parents[0].get<clang::Decl>())) {
@@ -80,15 +162,23 @@ class Context {
           break;
         }
       }
+      m_stats.count_depth(depth);
       // If no parent found, use root as parent node
       if (!node->parent) {
         node->parent = &m_root;
       }
       // Make sure to add children to the parent
       node->parent->children.push_back(node);
+      // Only comments can be spilled
+      if (node->comment.size()) {
+        m_resident.push_back(node);
+      }
+      account_memory(node_memory + decl_memory + node->comment.capacity() + node->signature.capacity()
+          + node->name.capacity() + node->qualified_name.capacity());
       return node;
     }
     // Means the node has not been registered!
+    Stats::count(m_stats.skipped_no_comment);
     return nullptr;
   }
 
@@ -103,6 +193,10 @@ class Context {
   void register_function_node(const clang::Decl* decl) {
     register_node(decl, m_functions);
   }
+
+  void register_record_node(const clang::Decl* decl) {
+    register_node(decl, m_records);
+  }
 };
 
 }
@@ -3,6 +3,7 @@
 
 #include <clong/config.hpp>
 #include <clong/clang.hpp>
+#include <clong/Segment.hpp>
 
 namespace clong {
 
@@ -10,8 +11,23 @@ namespace clong {
 struct Node {
   Node* parent;
   std::string comment;
+  /// Rendered once at registration, so they can be used after the AST is gone
+  std::string signature;
+  std::string name;
+  std::string qualified_name;
+  /// Declaration kind name (e.g. `Function`), static string from `clang`
+  const char* kind = "";
+  /// Only valid while the translation unit of the node is being processed
   const clang::Decl* decl;
   std::vector<Node*> children;
+  /// Set when `comment` has been spilled to disk (see `Context::spill`)
+  const Segment* segment = nullptr;
+  SegmentHandle comment_handle;
+
+  /// Comment of this node, read back from disk if it has been spilled
+  std::string comment_text() const {
+    return segment ? segment->read(comment_handle) : comment;
+  }
 };
 
 /// The root node of an AST
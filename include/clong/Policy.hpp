@@ -0,0 +1,44 @@
+#ifndef CLONG_POLICY_HPP
+#define CLONG_POLICY_HPP
+
+#include <clong/config.hpp>
+
+namespace clong {
+namespace policy {
+
+/// Documents every supported declaration kind
+struct All {
+  static constexpr bool namespaces = true;
+  /// Classes, structs, unions and class templates
+  static constexpr bool records = true;
+  /// Free functions and function templates
+  static constexpr bool functions = true;
+  static constexpr bool methods = true;
+  static constexpr bool vars = true;
+  /// Enums and their constants
+  static constexpr bool enums = true;
+  /// Statements (function bodies, initializers...) can only hold local declarations
+  static constexpr bool statements = true;
+};
+
+/// Documents the public API only: namespaces, classes and free functions
+struct Public {
+  static constexpr bool namespaces = true;
+  static constexpr bool records = true;
+  static constexpr bool functions = true;
+  static constexpr bool methods = false;
+  static constexpr bool vars = false;
+  static constexpr bool enums = false;
+  static constexpr bool statements = false;
+};
+
+/// Pre-instantiated policies, selectable at runtime (see `--kinds`)
+enum class Kinds {
+  all,
+  public_api
+};
+
+}
+}
+
+#endif
@@ -4,6 +4,9 @@
 #include <clong/config.hpp>
 #include <clong/clang.hpp>
 #include <clong/Node.hpp>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
 
 namespace clong {
 
@@ -17,22 +20,48 @@ class PrettyPrinter {
     return std::equal(with.rbegin(), with.rend(), str.rbegin());
   }
 
+  /// Per-thread printing state, reused across calls
+  struct Printer {
+    clang::PrintingPolicy pp{clang::LangOptions()};
+    std::string buffer;
+    llvm::raw_string_ostream ss{buffer};
+
+    Printer() {
+      // Skip body pprinting (function + class bodies)
+      pp.TerseOutput = true;
+    }
+
+    static Printer& get() {
+      thread_local Printer printer;
+      return printer;
+    }
+  };
+
   public:
-  static std::string pprint(const clang::Decl* decl, clang::LangOptions const& lo) {
+  /// Rebuild the printing policy of the current thread, must be called for each new TU
+  static void set_lang_options(clang::LangOptions const& lo) {
+    auto& printer = Printer::get();
+    printer.pp = clang::PrintingPolicy(lo);
+    printer.pp.TerseOutput = true;
+  }
+
+  /// Uses language options of the TU being processed (see `set_lang_options`)
+  static std::string pprint(const clang::Decl* decl) {
     assert(decl && "`decl` cannot be null");
-    clang::PrintingPolicy pp(lo);
-    // Skip body pprinting (function + class bodies)
-    pp.TerseOutput = true;
-    // Create steam and buffer
-    std::string s;
-    llvm::raw_string_ostream ss(s);
+    auto& printer = Printer::get();
     // Extract pretty representation of the decl
-    decl->print(ss, pp);
+    printer.buffer.clear();
+    decl->print(printer.ss, printer.pp);
     // Force flush of stream
-    s = ss.str();
-    // Post-process pprinted buffer
-    s.erase(std::remove(s.begin(), s.end(), '\n'), s.end());
-    // Check for " {}"
+    printer.ss.flush();
+    auto const& b = printer.buffer;
+    // Post-process pprinted buffer (skipping new lines)
+    std::string s;
+    s.reserve(b.size());
+    std::copy_if(b.begin(), b.end(), std::back_inserter(s), [](char c) {
+      return c != '\n';
+    });
+    // Check for " {}" (once new lines are removed, e.g. `namespace foo {\n}`)
     std::string bad_brackets = " {}";
     if (ends_with(s, bad_brackets)) {
       s.erase(s.end() - bad_brackets.length(), s.end());
@@ -40,11 +69,6 @@ class PrettyPrinter {
     return s;
   }
 
-  static std::string pprint(const clang::Decl* decl) {
-    clang::LangOptions lo;
-    return pprint(decl, lo);
-  }
-
   static std::string ascii_encode(std::string const& s) {
     std::string e;
     for (char c : s) {
@@ -58,24 +82,33 @@ class PrettyPrinter {
   }
 
   static std::string pprint(const RootNode* node) {
-    std::string p;
+    std::ostringstream p;
+    pprint(p, node);
+    return p.str();
+  }
+
+  static std::string pprint(const Node* node, int level = 0) {
+    std::ostringstream p;
+    pprint(p, node, level);
+    return p.str();
+  }
+
+  /// Stream version, nodes are written one by one (comments might be read back from disk)
+  static void pprint(std::ostream& o, const RootNode* node) {
     for (auto const* child : node->children) {
-      p += pprint(child);
+      pprint(o, child);
     }
-    return p;
   }
 
-  static std::string pprint(const Node* node, int level = 0) {
-    std::string p;
+  static void pprint(std::ostream& o, const Node* node, int level = 0) {
     std::string prefix = "- ";
     for (int i = 0; i < level; ++i) {
       prefix += "  ";
     }
-    p += prefix + pprint(node->decl) + " -- " + ascii_encode(node->comment) + "\n";
+    o << prefix << node->signature << " -- " << ascii_encode(node->comment_text()) << "\n";
     for (auto const* child : node->children) {
-      p += pprint(child, level + 1);
+      pprint(o, child, level + 1);
     }
-    return p;
   }
 
   static std::string pprint_comments(const clang::comments::Comment* com) {
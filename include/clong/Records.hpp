@@ -0,0 +1,290 @@
+#ifndef CLONG_RECORDS_HPP
+#define CLONG_RECORDS_HPP
+
+#include <clong/config.hpp>
+#include <clong/Node.hpp>
+#include <clong/hash.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace clong {
+
+/// A documented declaration, as stored in a records file to compare runs
+///
+/// Records files are sorted by (`name`, `kind`, `signature`), one record per line:
+/// `<name>\t<kind>\t<signature hash>\t<comment hash>\t<signature>`
+struct Record {
+  std::string name;
+  std::string kind;
+  std::uint64_t signature_hash;
+  std::uint64_t comment_hash;
+  std::string signature;
+
+  bool same_key(Record const& other) const {
+    return name == other.name && kind == other.kind;
+  }
+
+  bool key_less(Record const& other) const {
+    return std::tie(name, kind) < std::tie(other.name, other.kind);
+  }
+
+  bool operator<(Record const& other) const {
+    return std::tie(name, kind, signature) < std::tie(other.name, other.kind, other.signature);
+  }
+};
+
+/// Changes between two records files
+struct Changes {
+  std::size_t added = 0;
+  std::size_t removed = 0;
+  std::size_t changed = 0;
+  /// Set if a file could not be read (missing, malformed or unsorted), changes are then partial
+  std::string error;
+};
+
+class Records {
+  private:
+  static std::string sanitize(std::string s) {
+    std::replace(s.begin(), s.end(), '\t', ' ');
+    return s;
+  }
+
+  /// Collect records of `node` and its children, with the size of their comment
+  static void collect(const Node* node, std::vector<std::pair<Record, std::size_t>>& records) {
+    auto comment = node->comment_text();
+    records.push_back({{
+        sanitize(node->qualified_name), node->kind,
+        hash::fnv1a(node->signature), hash::fnv1a(comment),
+        sanitize(node->signature)}, comment.size()});
+    for (auto const* child : node->children) {
+      collect(child, records);
+    }
+  }
+
+  /// Sequential reader of a records file, blank lines are skipped
+  class Reader {
+    std::string m_path;
+    std::ifstream m_file;
+    Record m_record;
+    bool m_valid = false;
+    std::size_t m_line = 0;
+    std::string m_error;
+
+    private:
+    static bool parse_hash(std::string const& s, std::uint64_t& h) {
+      char* end = nullptr;
+      h = std::strtoull(s.c_str(), &end, 16);
+      return !s.empty() && std::isxdigit(static_cast<unsigned char>(s[0])) && *end == '\0';
+    }
+
+    void fail(std::string const& what) {
+      m_valid = false;
+      m_error = m_path + ":" + std::to_string(m_line) + ": " + what;
+    }
+
+    public:
+    Reader(std::string const& path)
+      : m_path(path), m_file(path) {
+      if (!m_file.is_open()) {
+        m_error = "unable to open " + path;
+        return;
+      }
+      next();
+    }
+
+    bool valid() const {
+      return m_valid;
+    }
+
+    /// Empty unless the file could not be read
+    std::string const& error() const {
+      return m_error;
+    }
+
+    Record const& get() const {
+      return m_record;
+    }
+
+    void next() {
+      std::string line;
+      auto had_previous = m_valid;
+      Record previous;
+      std::swap(previous, m_record);
+      m_valid = false;
+      if (m_error.size()) {
+        return;
+      }
+      do {
+        if (!std::getline(m_file, line)) {
+          if (m_file.bad()) {
+            fail("read error");
+          }
+          return;
+        }
+        ++m_line;
+      } while (line.find_first_not_of(" \t\r") == std::string::npos);
+      if (line.back() == '\r') {
+        line.pop_back();
+      }
+      std::istringstream fields(line);
+      std::string signature_hash, comment_hash;
+      if (!std::getline(fields, m_record.name, '\t') || !std::getline(fields, m_record.kind, '\t')
+          || !std::getline(fields, signature_hash, '\t') || !std::getline(fields, comment_hash, '\t')
+          || !parse_hash(signature_hash, m_record.signature_hash)
+          || !parse_hash(comment_hash, m_record.comment_hash)) {
+        fail("malformed record");
+        return;
+      }
+      std::getline(fields, m_record.signature);
+      // Records are merged by key, so keys must not go backwards
+      if (had_previous && m_record.key_less(previous)) {
+        fail("records are not sorted");
+        return;
+      }
+      m_valid = true;
+    }
+
+    /// Read all the records having the same key as the current one
+    std::vector<Record> group() {
+      std::vector<Record> records{m_record};
+      next();
+      while (m_valid && m_record.same_key(records.front())) {
+        records.push_back(m_record);
+        next();
+      }
+      return records;
+    }
+  };
+
+  static void report(std::ostream& o, char change, Record const& r, std::string const& what = "") {
+    o << change << " " << r.kind << " " << r.name;
+    if (what.size()) {
+      o << " (" << what << ")";
+    }
+    o << "\t" << r.signature << "\n";
+  }
+
+  /// Match records of the same key: identical signatures first, then remaining ones in order
+  static void diff_group(std::vector<Record>& olds, std::vector<Record>& news, std::ostream& o,
+      Changes& changes) {
+    std::vector<bool> matched(news.size(), false);
+    std::vector<Record const*> unmatched;
+    for (auto const& r : olds) {
+      auto it = std::find_if(news.begin(), news.end(), [&](Record const& n) {
+        return !matched[&n - news.data()] && n.signature_hash == r.signature_hash;
+      });
+      if (it == news.end()) {
+        unmatched.push_back(&r);
+        continue;
+      }
+      matched[it - news.begin()] = true;
+      if (it->comment_hash != r.comment_hash) {
+        report(o, '~', *it, "comment");
+        changes.changed++;
+      }
+    }
+    auto u = unmatched.begin();
+    for (std::size_t i = 0; i < news.size(); ++i) {
+      if (matched[i]) {
+        continue;
+      }
+      if (u == unmatched.end()) {
+        report(o, '+', news[i]);
+        changes.added++;
+        continue;
+      }
+      report(o, '~', news[i], "signature, was: " + (*u)->signature);
+      changes.changed++;
+      ++u;
+    }
+    for (; u != unmatched.end(); ++u) {
+      report(o, '-', **u);
+      changes.removed++;
+    }
+  }
+
+  public:
+  /// Records of all the nodes, sorted
+  ///
+  /// Nodes of the same declaration (e.g. a header seen from several TUs) have a single record, of
+  /// the most documented one (as for the pages of the site).
+  static std::vector<Record> collect(const RootNode& root) {
+    std::vector<std::pair<Record, std::size_t>> collected;
+    for (auto const* child : root.children) {
+      collect(child, collected);
+    }
+    // Most documented first among the same declarations
+    std::sort(collected.begin(), collected.end(), [](auto const& a, auto const& b) {
+      return std::tie(a.first, b.second, a.first.comment_hash)
+        < std::tie(b.first, a.second, b.first.comment_hash);
+    });
+    std::vector<Record> records;
+    for (auto& c : collected) {
+      if (records.empty() || records.back() < c.first) {
+        records.push_back(std::move(c.first));
+      }
+    }
+    return records;
+  }
+
+  static void write(std::string const& path, std::vector<Record> const& records) {
+    std::ofstream o(path, std::ofstream::out);
+    o << std::hex;
+    for (auto const& r : records) {
+      o << r.name << "\t" << r.kind << "\t" << r.signature_hash << "\t" << r.comment_hash << "\t"
+        << r.signature << "\n";
+    }
+  }
+
+  /// Compare two sorted records files in a single pass, writing a change report to `o`
+  ///
+  /// Each line is `<change> <kind> <name> [(<what>)]\t<signature>`, where change is one of `+`
+  /// (added), `-` (removed) or `~` (changed). Stops at the first unreadable record (see
+  /// `Changes::error`).
+  static Changes diff(std::string const& old_path, std::string const& new_path, std::ostream& o) {
+    Changes changes;
+    Reader olds(old_path);
+    Reader news(new_path);
+    while ((olds.valid() || news.valid()) && olds.error().empty() && news.error().empty()) {
+      // Only the order of keys matters here
+      auto cmp = !olds.valid() ? 1 : !news.valid() ? -1
+        : olds.get().name != news.get().name ? olds.get().name.compare(news.get().name)
+        : olds.get().kind.compare(news.get().kind);
+      if (cmp < 0) {
+        for (auto const& r : olds.group()) {
+          report(o, '-', r);
+          changes.removed++;
+        }
+      } else if (cmp > 0) {
+        for (auto const& r : news.group()) {
+          report(o, '+', r);
+          changes.added++;
+        }
+      } else {
+        auto old_group = olds.group();
+        auto new_group = news.group();
+        diff_group(old_group, new_group, o, changes);
+      }
+    }
+    changes.error = olds.error().size() ? olds.error() : news.error();
+    if (changes.error.size()) {
+      return changes;
+    }
+    o << changes.added << " added, " << changes.removed << " removed, "
+      << changes.changed << " changed\n";
+    return changes;
+  }
+};
+
+}
+
+#endif
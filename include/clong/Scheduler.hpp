@@ -0,0 +1,214 @@
+#ifndef CLONG_SCHEDULER_HPP
+#define CLONG_SCHEDULER_HPP
+
+#include <clong/config.hpp>
+#include <clong/clang.hpp>
+#include <clong/fs.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace clong {
+
+/// Cost of a translation unit, as recorded during a previous run
+struct Cost {
+  double seconds;
+  std::size_t memory;
+};
+
+/// Per-TU costs of previous runs, stored in a small local text file
+///
+/// Each line is: `<seconds> <memory> <path>`
+class History {
+  std::string m_path;
+  std::unordered_map<std::string, Cost> m_costs;
+
+  public:
+  History(std::string const& path)
+    : m_path(path) {
+    if (m_path.empty()) {
+      return;
+    }
+    std::ifstream i(m_path);
+    Cost cost;
+    std::string file;
+    while (i >> cost.seconds >> cost.memory) {
+      // Path is last so it can contain spaces
+      i.ignore(1);
+      if (std::getline(i, file)) {
+        m_costs[file] = cost;
+      }
+    }
+  }
+
+  public:
+  const Cost* find(std::string const& file) const {
+    auto it = m_costs.find(file);
+    return it != m_costs.end() ? &it->second : nullptr;
+  }
+
+  void update(std::string const& file, Cost const& cost) {
+    m_costs[file] = cost;
+  }
+
+  void save() const {
+    if (m_path.empty()) {
+      return;
+    }
+    std::ofstream o(m_path, std::ofstream::out);
+    for (auto const& entry : m_costs) {
+      o << entry.second.seconds << " " << entry.second.memory << " " << entry.first << "\n";
+    }
+  }
+};
+
+/// Runs a tool over translation units, longest first, using the costs of previous runs
+///
+/// Workers pull the next most expensive TU as soon as they are idle, and a TU is only started
+/// if its recorded memory fits in the memory budget (alongside the TUs being processed).
+class Scheduler {
+  History m_history;
+  unsigned m_jobs;
+  std::size_t m_max_memory;
+
+  // Memory throttling
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::size_t m_reserved = 0;
+  unsigned m_running = 0;
+
+  private:
+  /// Memory used by the TU being processed on the current thread
+  static std::size_t& tu_memory() {
+    thread_local std::size_t memory = 0;
+    return memory;
+  }
+
+  void acquire(std::size_t memory) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // Always let a TU run if nothing else is running, otherwise it could never run
+    m_cv.wait(lock, [&] {
+      return !m_max_memory || !m_running || m_reserved + memory <= m_max_memory;
+    });
+    m_reserved += memory;
+    m_running++;
+  }
+
+  void release(std::size_t memory) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_reserved -= memory;
+      m_running--;
+    }
+    m_cv.notify_all();
+  }
+
+  public:
+  /// `jobs` is the number of workers (0 means one per core), `max_memory` is in bytes (0 means
+  /// unlimited)
+  Scheduler(std::string const& history, unsigned jobs, std::size_t max_memory)
+    : m_history(history), m_jobs(jobs), m_max_memory(max_memory) {
+    if (!m_jobs) {
+      m_jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+#if CLANG_VERSION_MAJOR < 8
+    // Tools change the working directory of the whole process, so TUs cannot run concurrently
+    m_jobs = 1;
+#endif
+  }
+
+  public:
+  /// To be called while processing a TU to record its memory usage
+  static void report_memory(std::size_t memory) {
+    tu_memory() = std::max(tu_memory(), memory);
+  }
+
+  /// Sort TUs longest first (unknown TUs first, as they might be the longest ones)
+  std::vector<std::string> schedule(std::vector<std::string> const& sources) const {
+    auto ordered = sources;
+    std::stable_sort(ordered.begin(), ordered.end(), [&](auto const& a, auto const& b) {
+      auto* ca = m_history.find(a);
+      auto* cb = m_history.find(b);
+      if (!ca || !cb) {
+        return !ca && cb;
+      }
+      return ca->seconds > cb->seconds;
+    });
+    return ordered;
+  }
+
+  int run(clang::tooling::CompilationDatabase const& db,
+      std::vector<std::string> const& sources, clang::tooling::ArgumentsAdjuster adjuster,
+      clang::tooling::ToolAction* action) {
+    auto ordered = schedule(sources);
+    // Snapshot recorded memory, as history gets updated concurrently by workers
+    std::vector<std::size_t> memories;
+    for (auto const& file : ordered) {
+      auto* previous = m_history.find(file);
+      memories.push_back(previous ? previous->memory : 0);
+    }
+    std::atomic<std::size_t> next(0);
+    std::atomic<int> result(0);
+    std::mutex history_mutex;
+
+    auto worker = [&] {
+      for (auto i = next++; i < ordered.size(); i = next++) {
+        auto const& file = ordered[i];
+        auto memory = memories[i];
+        acquire(memory);
+        tu_memory() = 0;
+        auto start = std::chrono::steady_clock::now();
+#if CLANG_VERSION_MAJOR >= 8
+        // Tools change the working directory of their file system to the one of the compile
+        // command, so each tool gets its own instead of the process-wide one
+        clang::tooling::ClangTool tool(db, std::vector<std::string>{file},
+            std::make_shared<clang::PCHContainerOperations>(),
+            llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(
+              llvm::vfs::createPhysicalFileSystem().release()));
+#else
+        clang::tooling::ClangTool tool(db, std::vector<std::string>{file});
+#endif
+        tool.appendArgumentsAdjuster(adjuster);
+        auto r = tool.run(action);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        release(memory);
+        // Keep the worst result (0: ok, 1: error, 2: skipped files)
+        int current = result;
+        while (r > current && !result.compare_exchange_weak(current, r)) {
+        }
+        if (r == 0) {
+          std::lock_guard<std::mutex> lock(history_mutex);
+          m_history.update(file, {elapsed.count(), tu_memory()});
+        }
+      }
+    };
+
+    auto jobs = std::min<std::size_t>(m_jobs, ordered.size());
+    if (jobs <= 1) {
+      // No need for threads here
+      worker();
+    } else {
+      std::vector<std::thread> workers;
+      for (std::size_t i = 0; i < jobs; ++i) {
+        workers.emplace_back(worker);
+      }
+      for (auto& w : workers) {
+        w.join();
+      }
+    }
+    m_history.save();
+    return result;
+  }
+};
+
+}
+
+#endif
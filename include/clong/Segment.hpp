@@ -0,0 +1,83 @@
+#ifndef CLONG_SEGMENT_HPP
+#define CLONG_SEGMENT_HPP
+
+#include <clong/config.hpp>
+#include <clong/clang.hpp>
+#include <clong/fs.hpp>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace clong {
+
+/// Location of some text stored in a `Segment`
+struct SegmentHandle {
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+/// Append-only on-disk storage, used to spill text out of memory
+///
+/// The file is temporary and removed when the segment is destroyed.
+class Segment {
+  std::string m_path;
+  mutable std::fstream m_file;
+  mutable std::mutex m_mutex;
+  std::uint64_t m_size = 0;
+
+  public:
+  Segment() {
+    llvm::SmallString<128> path;
+    if (llvm::sys::fs::createTemporaryFile("clong", "seg", path)) {
+      llvm::report_fatal_error("unable to create segment file");
+    }
+    m_path = path.str();
+    m_file.open(m_path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!m_file) {
+      llvm::report_fatal_error("unable to open segment file: " + m_path);
+    }
+  }
+
+  Segment(Segment const&) = delete;
+  Segment& operator=(Segment const&) = delete;
+
+  ~Segment() {
+    m_file.close();
+    std::error_code ec;
+    fs::remove(m_path, ec);
+  }
+
+  public:
+  SegmentHandle append(std::string const& text) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SegmentHandle handle{m_size, text.size()};
+    m_file.seekp(m_size);
+    m_file.write(text.data(), text.size());
+    if (!m_file) {
+      llvm::report_fatal_error("unable to write segment file: " + m_path);
+    }
+    m_size += text.size();
+    return handle;
+  }
+
+  std::string read(SegmentHandle const& handle) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string text(handle.size, '\0');
+    // Seeking also flushes pending appends
+    m_file.seekg(handle.offset);
+    m_file.read(&text[0], text.size());
+    if (!m_file || std::uint64_t(m_file.gcount()) != handle.size) {
+      llvm::report_fatal_error("unable to read segment file: " + m_path);
+    }
+    return text;
+  }
+
+  std::uint64_t size() const {
+    return m_size;
+  }
+};
+
+}
+
+#endif
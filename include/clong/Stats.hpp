@@ -0,0 +1,142 @@
+#ifndef CLONG_STATS_HPP
+#define CLONG_STATS_HPP
+
+#include <clong/config.hpp>
+#include <clong/json.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if !CLONG_IS_MSVC
+#include <sys/resource.h>
+#endif
+
+namespace clong {
+
+/// Run statistics, cheap enough to always be collected (relaxed atomic counters)
+///
+/// Counters are mutable, so they can be counted through a const `Stats` (e.g. by writers, which
+/// only get a const `Context`).
+struct Stats {
+  using counter = std::atomic<std::uint64_t>;
+
+  /// One per `Visitor::Visit*` method
+  enum Kind {
+    namespace_decl,
+    cxx_record_decl,
+    class_template_decl,
+    function_decl,
+    function_template_decl,
+    var_decl,
+    enum_decl,
+    enum_constant_decl,
+    kind_count
+  };
+
+  /// Parent-walk depths of `Context::register_node`, last bucket holds deeper walks
+  static constexpr std::size_t depth_buckets = 16;
+
+  /// Timings of a translation unit (in seconds)
+  struct TU {
+    std::string file;
+    double parse;
+    double traverse;
+  };
+
+  mutable counter visited[kind_count] = {};
+  mutable counter registered{0};
+  mutable counter skipped_no_comment{0};
+  mutable counter auto_registered_parents{0};
+  mutable counter parent_depths[depth_buckets] = {};
+  mutable counter comment_bytes{0};
+  mutable counter pages_written{0};
+  mutable counter page_bytes_written{0};
+
+  private:
+  mutable std::mutex m_tus_mutex;
+  std::vector<TU> m_tus;
+
+  public:
+  static const char* name(Kind kind) {
+    switch (kind) {
+      case namespace_decl: return "NamespaceDecl";
+      case cxx_record_decl: return "CXXRecordDecl";
+      case class_template_decl: return "ClassTemplateDecl";
+      case function_decl: return "FunctionDecl";
+      case function_template_decl: return "FunctionTemplateDecl";
+      case var_decl: return "VarDecl";
+      case enum_decl: return "EnumDecl";
+      case enum_constant_decl: return "EnumConstantDecl";
+      default: return "?";
+    }
+  }
+
+  static void count(counter& c, std::uint64_t n = 1) {
+    c.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  void count_depth(std::size_t depth) const {
+    count(parent_depths[depth < depth_buckets ? depth : depth_buckets - 1]);
+  }
+
+  void add_tu(std::string const& file, double parse, double traverse) {
+    std::lock_guard<std::mutex> lock(m_tus_mutex);
+    m_tus.push_back({file, parse, traverse});
+  }
+
+  /// Peak resident set size of the process (in bytes, 0 if unknown)
+  static std::uint64_t peak_rss() {
+#if CLONG_IS_MSVC
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) {
+      return 0;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss;
+#else
+    return std::uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+  }
+
+  /// Write statistics as a JSON report
+  void write(std::string const& path) const {
+    std::ofstream o(path, std::ofstream::out);
+    o << "{\n  \"visited\": {";
+    for (int kind = 0; kind < kind_count; ++kind) {
+      o << (kind ? ", " : "") << json::quote(name(Kind(kind))) << ": " << visited[kind].load();
+    }
+    o << "},\n"
+      << "  \"registered\": " << registered.load() << ",\n"
+      << "  \"skipped_no_comment\": " << skipped_no_comment.load() << ",\n"
+      << "  \"auto_registered_parents\": " << auto_registered_parents.load() << ",\n"
+      << "  \"parent_depths\": [";
+    for (std::size_t depth = 0; depth < depth_buckets; ++depth) {
+      o << (depth ? ", " : "") << parent_depths[depth].load();
+    }
+    o << "],\n"
+      << "  \"comment_bytes\": " << comment_bytes.load() << ",\n"
+      << "  \"pages_written\": " << pages_written.load() << ",\n"
+      << "  \"page_bytes_written\": " << page_bytes_written.load() << ",\n"
+      << "  \"peak_rss\": " << peak_rss() << ",\n"
+      << "  \"tus\": [";
+    std::lock_guard<std::mutex> lock(m_tus_mutex);
+    for (std::size_t i = 0; i < m_tus.size(); ++i) {
+      auto const& tu = m_tus[i];
+      o << (i ? ",\n" : "\n")
+        << "    {\"file\": " << json::quote(tu.file)
+        << ", \"parse\": " << tu.parse
+        << ", \"traverse\": " << tu.traverse << "}";
+    }
+    o << "\n  ]\n}\n";
+  }
+};
+
+}
+
+#endif
@@ -6,11 +6,17 @@
 #include <clong/Node.hpp>
 #include <clong/PrettyPrinter.hpp>
 #include <clong/Context.hpp>
+#include <clong/Policy.hpp>
 
 namespace clong {
 
 /// The clang's visitor that visits each nodes
-class Visitor : public clang::RecursiveASTVisitor<Visitor> {
+///
+/// `Policy` selects the declaration kinds to document (see `policy::All`), disabled kinds are
+/// compiled out.
+template <typename Policy = policy::All>
+class Visitor : public clang::RecursiveASTVisitor<Visitor<Policy>> {
+  using base = clang::RecursiveASTVisitor<Visitor<Policy>>;
 
   clang::CompilerInstance& m_ci;
   Context& m_ctxt;
@@ -21,52 +27,93 @@ class Visitor : public clang::RecursiveASTVisitor<Visitor> {
   }
 
   public:
+  bool TraverseStmt(clang::Stmt* stmt, typename base::DataRecursionQueue* queue = nullptr) {
+    // Skip whole subtrees that cannot produce documented nodes
+    if (!Policy::statements) {
+      return true;
+    }
+    return base::TraverseStmt(stmt, queue);
+  }
+
   bool VisitNamespaceDecl(clang::NamespaceDecl* decl) {
+    if (!Policy::namespaces) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
+    Stats::count(m_ctxt.stats().visited[Stats::namespace_decl]);
     m_ctxt.register_node(decl);
     return true;
   }
 
   bool VisitCXXRecordDecl(clang::CXXRecordDecl* decl) {
+    if (!Policy::records) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
-    m_ctxt.register_node(decl);
+    Stats::count(m_ctxt.stats().visited[Stats::cxx_record_decl]);
+    m_ctxt.register_record_node(decl);
     return true;
   }
 
   bool VisitClassTemplateDecl(clang::ClassTemplateDecl* decl) {
+    if (!Policy::records) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
-    m_ctxt.register_node(decl);
+    Stats::count(m_ctxt.stats().visited[Stats::class_template_decl]);
+    m_ctxt.register_record_node(decl);
     m_ctxt.mark_as_visited(decl->getTemplatedDecl());
     return true;
   }
 
   bool VisitFunctionDecl(clang::FunctionDecl* decl) {
+    if (!Policy::functions || (!Policy::methods && clang::isa<clang::CXXMethodDecl>(decl))) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
+    Stats::count(m_ctxt.stats().visited[Stats::function_decl]);
     m_ctxt.register_function_node(decl);
     return true;
   }
 
   bool VisitFunctionTemplateDecl(clang::FunctionTemplateDecl* decl) {
+    if (!Policy::functions
+        || (!Policy::methods && clang::isa<clang::CXXMethodDecl>(decl->getTemplatedDecl()))) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
+    Stats::count(m_ctxt.stats().visited[Stats::function_template_decl]);
     m_ctxt.register_function_node(decl);
     m_ctxt.mark_as_visited(decl->getTemplatedDecl());
     return true;
   }
 
   bool VisitVarDecl(clang::VarDecl* decl) {
+    if (!Policy::vars) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
+    Stats::count(m_ctxt.stats().visited[Stats::var_decl]);
     m_ctxt.register_node(decl);
     return true;
   }
 
   bool VisitEnumDecl(clang::EnumDecl* decl) {
+    if (!Policy::enums) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
+    Stats::count(m_ctxt.stats().visited[Stats::enum_decl]);
     m_ctxt.register_node(decl);
     return true;
   }
 
   bool VisitEnumConstantDecl(clang::EnumConstantDecl* decl) {
+    if (!Policy::enums) {
+      return true;
+    }
     CLONG_LOG(debug, log::colored(decl));
+    Stats::count(m_ctxt.stats().visited[Stats::enum_constant_decl]);
     m_ctxt.register_node(decl);
     return true;
   }
@@ -14,10 +14,19 @@
 #include <clang/AST/Comment.h>
 #include <clang/AST/PrettyPrinter.h>
 #include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Basic/Version.h>
 #include <clang/Tooling/CommonOptionsParser.h>
+#include <clang/Tooling/JSONCompilationDatabase.h>
 #include <clang/Tooling/Tooling.h>
 #include <clang/Frontend/CompilerInstance.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/ErrorHandling.h>
+#if CLANG_VERSION_MAJOR >= 8
+#include <llvm/Support/VirtualFileSystem.h>
+#endif
 
 #if CLONG_IS_MSVC
 #pragma warning(pop)
@@ -6,6 +6,7 @@
 #include <clong/log.hpp>
 #include <clong/Context.hpp>
 #include <clong/Visitor.hpp>
+#include <clong/Records.hpp>
 #include <clong/jekyll/JustTheDocs.hpp>
 
 #endif
@@ -7,6 +7,12 @@ namespace clong {
 
 namespace fs = ::ghc::filesystem;
 
+/// Working directory of the process when first called (i.e. before any tool runs, see `run`)
+inline fs::path const& initial_path() {
+  static const fs::path path = fs::current_path();
+  return path;
+}
+
 }
 
 #endif
@@ -0,0 +1,29 @@
+#ifndef CLONG_HASH_HPP
+#define CLONG_HASH_HPP
+
+#include <clong/config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace clong {
+namespace hash {
+
+/// FNV-1a hash, stable across runs and platforms (unlike `std::hash`), so it can be stored
+inline std::uint64_t fnv1a(const char* data, std::size_t size,
+    std::uint64_t h = 14695981039346656037ull) {
+  for (std::size_t i = 0; i < size; ++i) {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+inline std::uint64_t fnv1a(std::string const& s) {
+  return fnv1a(s.data(), s.size());
+}
+
+}
+}
+
+#endif
@@ -4,31 +4,243 @@
 #include <clong/config.hpp>
 #include <clong/fs.hpp>
 #include <clong/jekyll/Template.hpp>
+#include <clong/jekyll/Linker.hpp>
+#include <clong/jekyll/Output.hpp>
+#include <clong/jekyll/SearchIndex.hpp>
+#include <clong/json.hpp>
+#include <clong/hash.hpp>
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
 
 namespace clong {
 namespace jekyll {
 
 class JustTheDocs : public Template<JustTheDocs> {
-  public:
-  static void write(std::string const& dst_dir, Context const& ctxt) {
-    auto src = make_src_path("just-the-docs");
-    auto dst = make_dst_path(dst_dir);
+  /// A generated reference page
+  struct Page {
+    const Node* node;
+    // Relative to the output directory, without extension
+    std::string path;
+    std::string url;
+  };
 
-    // Clear
-    fs::remove_all(dst);
-    // Copy default template content
-    fs::copy(src, dst, fs::copy_options::recursive);
-    // Create functions refs
-    {
-      auto path = make_dst_path(dst, "/refs/function/");
-      fs::create_directories(path);
-      for (auto* f : ctxt.functions()) {
-        // Get friendly name
-        auto name = ((clang::FunctionDecl*)f->decl)->getNameAsString();
-        make_md(fs::path(path).concat(name + ".md"), f->comment);
+  private:
+  static std::string html_escape(char c) {
+    switch (c) {
+      case '<': return "&lt;";
+      case '>': return "&gt;";
+      case '&': return "&amp;";
+      default: return std::string(1, c);
+    }
+  }
+
+  /// File name of a page (`::` becomes `.`, other non identifier characters become `_`)
+  static std::string make_page_name(std::string const& qualified_name) {
+    std::string name;
+    for (std::size_t i = 0; i < qualified_name.size(); ++i) {
+      char c = qualified_name[i];
+      if (c == ':' && i + 1 < qualified_name.size() && qualified_name[i + 1] == ':') {
+        name += '.';
+        ++i;
+      } else {
+        name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+      }
+    }
+    return name;
+  }
+
+  /// Add pages of `nodes` in `dir`, one per declaration
+  ///
+  /// Nodes of the same declaration (e.g. a header seen from several TUs) share a page, and
+  /// declarations having the same page name (e.g. overloads) get a hash of their signature appended.
+  static void add_pages(std::unordered_set<const Node*> const& nodes, std::string const& dir,
+      std::vector<Page>& pages) {
+    std::vector<Page> dir_pages;
+    for (auto* node : nodes) {
+      // Anonymous declarations cannot have a page
+      if (node->name.empty()) {
+        continue;
+      }
+      dir_pages.push_back({node, dir + make_page_name(node->qualified_name), ""});
+    }
+    auto key = [](Page const& p) {
+      return std::tie(p.path, p.node->signature);
+    };
+    std::sort(dir_pages.begin(), dir_pages.end(), [&](Page const& a, Page const& b) {
+      return key(a) < key(b);
+    });
+    // Merge nodes of the same declaration, keeping the most documented one
+    std::vector<Page> merged;
+    for (auto it = dir_pages.begin(); it != dir_pages.end();) {
+      auto next = std::find_if(it, dir_pages.end(), [&](Page const& p) {
+        return key(p) != key(*it);
+      });
+      auto best = it;
+      if (next - it > 1) {
+        auto best_comment = best->node->comment_text();
+        for (auto j = it + 1; j != next; ++j) {
+          auto comment = j->node->comment_text();
+          if (comment.size() > best_comment.size()
+              || (comment.size() == best_comment.size() && comment < best_comment)) {
+            best = j;
+            best_comment = std::move(comment);
+          }
+        }
+      }
+      merged.push_back(*best);
+      it = next;
+    }
+    // Disambiguate declarations having the same page name
+    for (std::size_t i = 0; i < merged.size();) {
+      auto j = i + 1;
+      while (j < merged.size() && merged[j].path == merged[i].path) {
+        ++j;
+      }
+      for (auto k = i; j - i > 1 && k < j; ++k) {
+        std::ostringstream suffix;
+        suffix << std::hex << (hash::fnv1a(merged[k].node->signature) & 0xffffffff);
+        merged[k].path += "-" + suffix.str();
+      }
+      i = j;
+    }
+    for (auto& page : merged) {
+      page.url = make_url(page.path);
+      pages.push_back(std::move(page));
+    }
+  }
+
+  /// Page content, with signature and comment linked to other pages
+  ///
+  /// Pages need a front matter to be rendered by jekyll (otherwise they are copied as is, and
+  /// their pretty url does not exist). They are not listed in the navigation, only linked.
+  static std::string make_page(Page const& page, std::string const& comment, Linker const& linker) {
+    std::string content = "---\n"
+      "layout: default\n"
+      "title: " + json::quote(page.node->qualified_name) + "\n"
+      "nav_exclude: true\n"
+      "---\n\n"
+      "<pre><code>";
+    linker.link(page.node->signature, page.url,
+        [&](char c) { content += html_escape(c); },
+        [&](std::string const& symbol, std::string const& url) {
+          content += "<a href=\"" + url + "\">" + symbol + "</a>";
+        });
+    content += "</code></pre>\n\n";
+    linker.link(comment, page.url,
+        [&](char c) { content += c; },
+        [&](std::string const& symbol, std::string const& url) {
+          content += "[" + symbol + "](" + url + ")";
+        });
+    return content;
+  }
+
+  static std::string trim(std::string const& s) {
+    auto begin = s.find_first_not_of(" \t\r\"'");
+    if (begin == std::string::npos) {
+      return "";
+    }
+    return s.substr(begin, s.find_last_not_of(" \t\r\"'") - begin + 1);
+  }
+
+  /// Add the markdown pages of the template (`src`) to the search index
+  ///
+  /// Only the front matter keys used by the theme's search are read: `title`, `permalink` and
+  /// `search_exclude`.
+  static void index_template_pages(fs::path const& src, SearchIndex& index) {
+    for (auto const& entry : Output::entries(src)) {
+      if (!entry.is_regular_file() || entry.path().extension() != ".md") {
+        continue;
+      }
+      fs::ifstream i(entry.path());
+      std::string line, title, permalink, content;
+      bool exclude = false;
+      // Front matter: `key: value` lines between two `---` lines
+      if (std::getline(i, line) && trim(line) == "---") {
+        while (std::getline(i, line) && trim(line) != "---") {
+          auto colon = line.find(':');
+          if (colon == std::string::npos) {
+            continue;
+          }
+          auto key = trim(line.substr(0, colon));
+          auto value = trim(line.substr(colon + 1));
+          if (key == "title") {
+            title = value;
+          } else if (key == "permalink") {
+            permalink = value;
+          } else if (key == "search_exclude") {
+            exclude = value == "true";
+          }
+        }
+      } else {
+        content = line + "\n";
       }
+      if (exclude) {
+        continue;
+      }
+      content.append(std::istreambuf_iterator<char>(i), std::istreambuf_iterator<char>());
+      // Same urls as jekyll's `pretty` permalinks
+      auto page = fs::relative(entry.path(), src).replace_extension().generic_string();
+      if (page == "index") {
+        page.clear();
+      } else if (page.size() > 6 && page.compare(page.size() - 6, 6, "/index") == 0) {
+        page.resize(page.size() - 6);
+      }
+      auto url = permalink.size() ? permalink : page.empty() ? "/" : make_url(page);
+      index.add(title, url, content);
     }
+  }
+
+  public:
+  /// Write the site to `out`
+  static void write(Output& out, Context const& ctxt) {
+    // Copy default template content
+    auto src = make_src_path("just-the-docs");
+    out.copy(src);
+    // Collect refs, so they can be linked to each other
+    std::vector<Page> pages;
+    out.directory("refs/function/");
+    add_pages(ctxt.functions(), "refs/function/", pages);
+    out.directory("refs/class/");
+    add_pages(ctxt.records(), "refs/class/", pages);
     // TODO: Other refs
+    Linker linker;
+    for (auto const& page : pages) {
+      linker.add(page.node->qualified_name, page.node->name, page.url);
+    }
+    // Search index, filled with template pages and while writing refs
+    SearchIndex index;
+    index_template_pages(src, index);
+    for (auto const& page : pages) {
+      auto comment = page.node->comment_text();
+      auto content = make_page(page, comment, linker);
+      // Unchanged pages might be skipped
+      if (out.file(page.path + ".md", content)) {
+        Stats::count(ctxt.stats().pages_written);
+        Stats::count(ctxt.stats().page_bytes_written, content.size());
+      }
+      index.add(page.node->name, page.url, comment);
+    }
+    // Pre-built search index (so jekyll does not have to build it)
+    index.write(out, "assets/js/");
+    out.finish();
+  }
+
+  /// Write the site in the `dst_dir` directory
+  static void write(std::string const& dst_dir, Context const& ctxt) {
+    DirectoryOutput out(make_dst_path(dst_dir));
+    write(out, ctxt);
+  }
+
+  /// Write the site as a single tar archive
+  static void write_archive(std::string const& path, Context const& ctxt) {
+    ArchiveOutput out(path);
+    write(out, ctxt);
   }
 };
 
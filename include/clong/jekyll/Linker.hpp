@@ -0,0 +1,118 @@
+#ifndef CLONG_JEKYLL_LINKER_HPP
+#define CLONG_JEKYLL_LINKER_HPP
+
+#include <clong/config.hpp>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+
+namespace clong {
+namespace jekyll {
+
+/// Cross-reference linker: links symbols of signatures and comments to their pages
+///
+/// Symbols are looked up in hash tables (by qualified name first, then by name when it is not
+/// ambiguous), and each text is tokenized once, so linking all pages is linear in their size.
+/// Names of several pages (e.g. overloads) are ambiguous, and not linked. Partially qualified
+/// symbols (e.g. `b::f` for `a::b::f`) are linked by name only when their qualifiers match.
+class Linker {
+  struct Target {
+    std::string qualified_name;
+    // Empty url means the name is ambiguous
+    std::string url;
+  };
+
+  std::unordered_map<std::string, std::string> m_qualified;
+  std::unordered_map<std::string, Target> m_names;
+
+  private:
+  static bool is_ident_start(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  static bool is_ident(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  static void add(std::unordered_map<std::string, std::string>& symbols,
+      std::string const& symbol, std::string const& url) {
+    auto it = symbols.emplace(symbol, url);
+    if (!it.second && it.first->second != url) {
+      it.first->second.clear();
+    }
+  }
+
+  /// Whether `symbol` is `qualified_name`, or its last components
+  static bool is_suffix(std::string const& symbol, std::string const& qualified_name) {
+    if (symbol.size() > qualified_name.size()) {
+      return false;
+    }
+    auto begin = qualified_name.size() - symbol.size();
+    return qualified_name.compare(begin, symbol.size(), symbol) == 0
+      && (begin == 0 || qualified_name.compare(begin - 2, 2, "::") == 0);
+  }
+
+  const std::string* find(std::string const& symbol) const {
+    auto q = m_qualified.find(symbol);
+    if (q != m_qualified.end()) {
+      return q->second.empty() ? nullptr : &q->second;
+    }
+    auto n = m_names.find(symbol.substr(symbol.rfind(':') + 1));
+    if (n != m_names.end() && !n->second.url.empty()
+        && is_suffix(symbol, n->second.qualified_name)) {
+      return &n->second.url;
+    }
+    return nullptr;
+  }
+
+  public:
+  void add(std::string const& qualified_name, std::string const& name, std::string const& url) {
+    add(m_qualified, qualified_name, url);
+    auto it = m_names.emplace(name, Target{qualified_name, url});
+    if (!it.second && it.first->second.url != url) {
+      it.first->second.url.clear();
+    }
+  }
+
+  /// Link symbols of `text`
+  ///
+  /// Symbols (identifiers, possibly qualified) are passed to `on_link(symbol, url)`, other
+  /// characters to `on_text(c)`. Links to `self` are not emitted.
+  template <typename OnText, typename OnLink>
+  void link(std::string const& text, std::string const& self, OnText on_text, OnLink on_link) const {
+    std::size_t i = 0;
+    while (i < text.size()) {
+      if (!is_ident_start(text[i]) || (i && is_ident(text[i - 1]))) {
+        on_text(text[i++]);
+        continue;
+      }
+      // Read a (possibly qualified) identifier
+      auto begin = i;
+      while (true) {
+        while (i < text.size() && is_ident(text[i])) {
+          ++i;
+        }
+        if (i + 2 < text.size() && text[i] == ':' && text[i + 1] == ':'
+            && is_ident_start(text[i + 2])) {
+          i += 2;
+        } else {
+          break;
+        }
+      }
+      auto symbol = text.substr(begin, i - begin);
+      auto* url = find(symbol);
+      if (url && *url != self) {
+        on_link(symbol, *url);
+      } else {
+        for (char c : symbol) {
+          on_text(c);
+        }
+      }
+    }
+  }
+};
+
+}
+}
+
+#endif
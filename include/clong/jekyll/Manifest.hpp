@@ -0,0 +1,73 @@
+#ifndef CLONG_JEKYLL_MANIFEST_HPP
+#define CLONG_JEKYLL_MANIFEST_HPP
+
+#include <clong/config.hpp>
+#include <clong/fs.hpp>
+#include <clong/hash.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace clong {
+namespace jekyll {
+
+/// Content hashes of the pages written in an output directory, so unchanged pages are not
+/// rewritten and pages that are not generated anymore can be removed
+///
+/// Stored as a dot file, which jekyll ignores. Each line is: `<hash> <page>`
+class Manifest {
+  fs::path m_path;
+  bool m_loaded = false;
+  std::unordered_map<std::string, std::uint64_t> m_previous;
+  std::unordered_map<std::string, std::uint64_t> m_current;
+
+  public:
+  Manifest(fs::path const& dst)
+    : m_path(fs::path(dst) / ".clong-manifest") {
+    fs::ifstream i(m_path);
+    m_loaded = i.is_open();
+    std::uint64_t h;
+    std::string page;
+    while (i >> h) {
+      i.ignore(1);
+      if (std::getline(i, page)) {
+        m_previous[page] = h;
+      }
+    }
+  }
+
+  public:
+  /// True if the output directory has been written by a previous run
+  bool loaded() const {
+    return m_loaded;
+  }
+
+  /// Record `page` (relative to the output directory), returns false if it is unchanged
+  bool update(std::string const& page, std::string const& content) {
+    auto h = hash::fnv1a(content);
+    m_current[page] = h;
+    auto it = m_previous.find(page);
+    return it == m_previous.end() || it->second != h || !fs::exists(fs::path(m_path).parent_path() / page);
+  }
+
+  /// Remove pages of the previous run that have not been updated, and save the manifest
+  void save() {
+    auto dst = fs::path(m_path).parent_path();
+    for (auto const& entry : m_previous) {
+      if (!m_current.count(entry.first)) {
+        std::error_code ec;
+        fs::remove(dst / entry.first, ec);
+      }
+    }
+    fs::ofstream o(m_path, fs::ofstream::out);
+    for (auto const& entry : m_current) {
+      o << entry.second << " " << entry.first << "\n";
+    }
+    m_previous = m_current;
+  }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef CLONG_JEKYLL_OUTPUT_HPP
+#define CLONG_JEKYLL_OUTPUT_HPP
+
+#include <clong/config.hpp>
+#include <clong/fs.hpp>
+#include <clong/jekyll/Manifest.hpp>
+#include <llvm/Support/ErrorHandling.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace clong {
+namespace jekyll {
+
+/// Where a generated site is written, paths are relative to the site root
+class Output {
+  public:
+  virtual ~Output() {}
+
+  /// Copy a whole directory (e.g. the template content) to the site root
+  virtual void copy(fs::path const& src) = 0;
+
+  virtual void directory(std::string const& path) = 0;
+
+  /// Write a file, returns false if it has been skipped (unchanged)
+  virtual bool file(std::string const& path, std::string const& content) = 0;
+
+  /// Must be called once everything has been written
+  virtual void finish() = 0;
+
+  /// Entries of `dir` (recursively), sorted by path so that outputs do not depend on the order of
+  /// the file system
+  static std::vector<fs::directory_entry> entries(fs::path const& dir) {
+    std::vector<fs::directory_entry> entries;
+    for (auto const& entry : fs::recursive_directory_iterator(dir)) {
+      entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+      return a.path() < b.path();
+    });
+    return entries;
+  }
+};
+
+/// Writes the site in a directory, only rewriting changed files (see `Manifest`)
+class DirectoryOutput : public Output {
+  fs::path m_dst;
+  Manifest m_manifest;
+
+  public:
+  DirectoryOutput(fs::path const& dst)
+    : m_dst(dst), m_manifest(dst) {
+    // Clear (unless we know which files were generated, to only rewrite changed ones)
+    if (!m_manifest.loaded()) {
+      fs::remove_all(m_dst);
+    }
+  }
+
+  public:
+  virtual void copy(fs::path const& src) override {
+    fs::copy(src, m_dst, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+  }
+
+  virtual void directory(std::string const& path) override {
+    fs::create_directories(m_dst / path);
+  }
+
+  virtual bool file(std::string const& path, std::string const& content) override {
+    if (!m_manifest.update(path, content)) {
+      return false;
+    }
+    fs::ofstream o(m_dst / path, fs::ofstream::out | fs::ofstream::binary);
+    o << content;
+    return true;
+  }
+
+  virtual void finish() override {
+    m_manifest.save();
+  }
+};
+
+/// Streams the whole site into a single uncompressed (ustar) tar archive, in one pass
+///
+/// Entries are accumulated in a large buffer, so the archive is written using few large writes.
+/// Paths longer than the ustar limit use pax extended headers. Entries have a fixed modification
+/// time, so identical sites give identical archives.
+class ArchiveOutput : public Output {
+  static constexpr std::size_t block_size = 512;
+  static constexpr std::size_t buffer_size = 4 * 1024 * 1024;
+
+  std::string m_path;
+  std::ofstream m_file;
+  std::string m_buffer;
+  std::unordered_set<std::string> m_directories;
+
+  private:
+  static void octal(char* field, std::size_t size, std::uint64_t value) {
+    // Right aligned, zero padded, NUL terminated
+    field[size - 1] = '\0';
+    for (std::size_t i = size - 1; i > 0; --i) {
+      field[i - 1] = static_cast<char>('0' + (value & 7));
+      value >>= 3;
+    }
+  }
+
+  void flush(bool force = false) {
+    if (force || m_buffer.size() >= buffer_size) {
+      m_file.write(m_buffer.data(), m_buffer.size());
+      if (!m_file) {
+        llvm::report_fatal_error("unable to write archive: " + m_path);
+      }
+      m_buffer.clear();
+    }
+  }
+
+  void pad() {
+    m_buffer.append((block_size - m_buffer.size() % block_size) % block_size, '\0');
+  }
+
+  void header(std::string const& path, char type, std::uint64_t size) {
+    char h[block_size] = {};
+    // Name does not fit, use a pax header to hold it (and a truncated name as fallback)
+    if (path.size() > 100) {
+      std::string record = " path=" + path + "\n";
+      // Record length includes its own decimal length
+      auto length = record.size() + 1;
+      while (std::to_string(length).size() + record.size() != length) {
+        length = std::to_string(length).size() + record.size();
+      }
+      record = std::to_string(length) + record;
+      header("PaxHeader", 'x', record.size());
+      m_buffer += record;
+      pad();
+    }
+    std::memcpy(h, path.data(), std::min<std::size_t>(path.size(), 100));
+    octal(h + 100, 8, type == '5' ? 0755 : 0644);
+    octal(h + 108, 8, 0);
+    octal(h + 116, 8, 0);
+    octal(h + 124, 12, size);
+    octal(h + 136, 12, 0);
+    h[156] = type;
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+    // Checksum is computed with its own field filled with spaces
+    std::memset(h + 148, ' ', 8);
+    std::uint64_t checksum = 0;
+    for (char c : h) {
+      checksum += static_cast<unsigned char>(c);
+    }
+    octal(h + 148, 7, checksum);
+    m_buffer.append(h, block_size);
+  }
+
+  /// Make sure all parent directories have an entry
+  void parents(std::string const& path) {
+    for (auto i = path.find('/'); i != std::string::npos; i = path.find('/', i + 1)) {
+      directory(path.substr(0, i));
+    }
+  }
+
+  public:
+  ArchiveOutput(std::string const& path)
+    : m_path(path), m_file(path, std::ofstream::out | std::ofstream::binary) {
+    if (!m_file) {
+      llvm::report_fatal_error("unable to open archive: " + m_path);
+    }
+    m_buffer.reserve(buffer_size + block_size);
+  }
+
+  public:
+  virtual void copy(fs::path const& src) override {
+    for (auto const& entry : entries(src)) {
+      auto path = fs::relative(entry.path(), src).generic_string();
+      if (entry.is_directory()) {
+        directory(path);
+      } else {
+        fs::ifstream i(entry.path(), fs::ifstream::in | fs::ifstream::binary);
+        file(path, std::string(std::istreambuf_iterator<char>(i), std::istreambuf_iterator<char>()));
+      }
+    }
+  }
+
+  virtual void directory(std::string const& path) override {
+    auto dir = path;
+    while (dir.size() && dir.back() == '/') {
+      dir.pop_back();
+    }
+    if (dir.empty() || !m_directories.insert(dir).second) {
+      return;
+    }
+    parents(dir);
+    header(dir + "/", '5', 0);
+    flush();
+  }
+
+  virtual bool file(std::string const& path, std::string const& content) override {
+    parents(path);
+    header(path, '0', content.size());
+    m_buffer += content;
+    pad();
+    flush();
+    return true;
+  }
+
+  virtual void finish() override {
+    // End of archive: two zero blocks
+    m_buffer.append(2 * block_size, '\0');
+    flush(true);
+    m_file.close();
+    if (!m_file) {
+      llvm::report_fatal_error("unable to write archive: " + m_path);
+    }
+  }
+};
+
+}
+}
+
+#endif
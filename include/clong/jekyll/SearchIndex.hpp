@@ -0,0 +1,158 @@
+#ifndef CLONG_JEKYLL_SEARCHINDEX_HPP
+#define CLONG_JEKYLL_SEARCHINDEX_HPP
+
+#include <clong/config.hpp>
+#include <clong/json.hpp>
+#include <clong/jekyll/Output.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clong {
+namespace jekyll {
+
+/// Pre-tokenized search index, generated once by `clong` instead of by jekyll/Liquid
+///
+/// Produces two kinds of files:
+/// - `search-data.json`: the documents table (id -> title/url), in the just-the-docs theme format
+/// - `search/<c>.json`: one shard per leading character of the indexed terms. Each shard has its
+///   terms sorted so that a prefix lookup is a binary search, and the matching doc ids
+///
+/// The template's `assets/js/just-the-docs.js` overrides the theme's search to load only the shards
+/// of the query terms. Content is not kept, so the index is small both in memory and to download.
+class SearchIndex {
+  struct Doc {
+    std::string title;
+    std::string url;
+  };
+
+  /// Terms longer than this are truncated (they are useless for prefix search anyway)
+  static constexpr std::size_t max_term_length = 64;
+
+  std::vector<Doc> m_docs;
+  // shard -> term -> doc ids (ids are appended in increasing order)
+  std::map<char, std::unordered_map<std::string, std::vector<std::uint32_t>>> m_shards;
+
+  private:
+  static bool is_term_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  static char shard_of(std::string const& term) {
+    char c = term[0];
+    return std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+  }
+
+  void add_term(std::string term, std::uint32_t id) {
+    if (term.empty()) {
+      return;
+    }
+    if (term.size() > max_term_length) {
+      term.resize(max_term_length);
+    }
+    auto& ids = m_shards[shard_of(term)][term];
+    // Docs are added sequentially, so checking the last id is enough to deduplicate
+    if (ids.empty() || ids.back() != id) {
+      ids.push_back(id);
+    }
+  }
+
+  void add_text(std::string const& text, std::uint32_t id) {
+    std::string term;
+    for (std::size_t i = 0; i <= text.size(); ++i) {
+      char c = i < text.size() ? text[i] : ' ';
+      if (is_term_char(c)) {
+        term += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        continue;
+      }
+      if (term.empty()) {
+        continue;
+      }
+      add_term(term, id);
+      // Also index each part of snake_case identifiers
+      if (term.find('_') != std::string::npos) {
+        std::string part;
+        for (char t : term + "_") {
+          if (t == '_') {
+            add_term(part, id);
+            part.clear();
+          } else {
+            part += t;
+          }
+        }
+      }
+      term.clear();
+    }
+  }
+
+  public:
+  /// Add a document to the index, `text` is tokenized right away
+  void add(std::string const& title, std::string const& url, std::string const& text) {
+    auto id = static_cast<std::uint32_t>(m_docs.size());
+    m_docs.push_back({title, url});
+    add_text(title, id);
+    add_text(text, id);
+  }
+
+  /// Write the documents table and all the shards in `dir` (usually `assets/js/`)
+  void write(Output& out, std::string const& dir) const {
+    out.directory(dir);
+    // Documents table
+    {
+      std::ostringstream o;
+      o << "{";
+      for (std::size_t id = 0; id < m_docs.size(); ++id) {
+        auto const& doc = m_docs[id];
+        auto url = json::quote(doc.url);
+        o << (id ? ",\n" : "\n")
+          << "\"" << id << "\": {"
+          << "\"id\": \"" << id << "\", "
+          << "\"title\": " << json::quote(doc.title) << ", "
+          << "\"url\": " << url << ", "
+          << "\"relUrl\": " << url << "}";
+      }
+      o << "\n}\n";
+      out.file(dir + "search-data.json", o.str());
+    }
+    // Shards
+    auto shards_dir = dir + "search/";
+    out.directory(shards_dir);
+    for (auto const& shard : m_shards) {
+      // Sort terms so the client can binary search a prefix
+      std::vector<std::string const*> terms;
+      terms.reserve(shard.second.size());
+      for (auto const& entry : shard.second) {
+        terms.push_back(&entry.first);
+      }
+      std::sort(terms.begin(), terms.end(), [](auto const* a, auto const* b) {
+        return *a < *b;
+      });
+      std::ostringstream o;
+      o << "{\"terms\": [";
+      for (std::size_t i = 0; i < terms.size(); ++i) {
+        o << (i ? "," : "") << json::quote(*terms[i]);
+      }
+      o << "],\n\"docs\": [";
+      for (std::size_t i = 0; i < terms.size(); ++i) {
+        o << (i ? ",[" : "[");
+        auto const& ids = shard.second.at(*terms[i]);
+        for (std::size_t j = 0; j < ids.size(); ++j) {
+          o << (j ? "," : "") << ids[j];
+        }
+        o << "]";
+      }
+      o << "]}\n";
+      out.file(shards_dir + std::string(1, shard.first) + ".json", o.str());
+    }
+  }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CLONG_JSON_HPP
+#define CLONG_JSON_HPP
+
+#include <clong/config.hpp>
+#include <string>
+
+namespace clong {
+namespace json {
+
+/// Escape a string so it can be used as a JSON string literal (without quotes)
+inline std::string escape(std::string const& s) {
+  static const char* hex = "0123456789abcdef";
+  std::string e;
+  e.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '"':  e += "\\\""; break;
+      case '\\': e += "\\\\"; break;
+      case '\n': e += "\\n";  break;
+      case '\r': e += "\\r";  break;
+      case '\t': e += "\\t";  break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          e += "\\u00";
+          e += hex[(c >> 4) & 0xf];
+          e += hex[c & 0xf];
+        } else {
+          e += c;
+        }
+    }
+  }
+  return e;
+}
+
+/// Quote and escape a string as a JSON string literal
+inline std::string quote(std::string const& s) {
+  return "\"" + escape(s) + "\"";
+}
+
+}
+}
+
+#endif
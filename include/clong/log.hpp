@@ -35,10 +35,14 @@ std::string colored(const clang::Decl* decl) {
   return colorize(::fmt::color::blue_violet, PrettyPrinter::pprint(decl));
 }
 
-/// For convenience
-#define CLONG_LOG(level, ...) \
-  ::clong::log::level(::clong::format("{}:{}:{}: ", \
-        ::clong::log::pretty_filename(__FILE__), __FUNCTION__, __LINE__) + __VA_ARGS__);
+/// For convenience (arguments are only evaluated if `lvl` is enabled)
+#define CLONG_LOG(lvl, ...) \
+  do { \
+    if (::clong::log::default_logger_raw()->should_log(::clong::log::level::lvl)) { \
+      ::clong::log::lvl(::clong::format("{}:{}:{}: ", \
+            ::clong::log::pretty_filename(__FILE__), __FUNCTION__, __LINE__) + __VA_ARGS__); \
+    } \
+  } while (0)
 /**/
 
 }
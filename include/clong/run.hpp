@@ -1,6 +1,10 @@
 #ifndef CLONG_RUN_HPP
 #define CLONG_RUN_HPP
 
+#include <clong/CompilationCache.hpp>
+#include <clong/Records.hpp>
+#include <clong/Scheduler.hpp>
+
 namespace clong {
 
 // Apply a custom category to all command-line options so that they are the
@@ -8,22 +12,120 @@ namespace clong {
 namespace cl = llvm::cl;
 static cl::OptionCategory OptionsCategory("clong options");
 
+// -p <dir>
+static cl::opt<std::string> BuildPath("p",
+    cl::desc("Build path (where to look for compile_commands.json)"), cl::value_desc("dir"),
+    cl::Optional, cl::cat(OptionsCategory));
+
+// <sources>
+static cl::list<std::string> SourcePaths(cl::Positional,
+    cl::desc("<source0> [... <sourceN>]"), cl::OneOrMore, cl::cat(OptionsCategory));
+
+// --extra-arg <arg>
+static cl::list<std::string> ArgsAfter("extra-arg",
+    cl::desc("Additional argument to append to the compiler command line"),
+    cl::cat(OptionsCategory));
+
+// --extra-arg-before <arg>
+static cl::list<std::string> ArgsBefore("extra-arg-before",
+    cl::desc("Additional argument to prepend to the compiler command line"),
+    cl::cat(OptionsCategory));
+
 // -O <dir>
 static cl::opt<std::string> OutputDir("O",
-    cl::desc("Specify output directory"), cl::value_desc("dir"), cl::init("_doc"));
+    cl::desc("Specify output directory"), cl::value_desc("dir"), cl::init("_doc"),
+    cl::cat(OptionsCategory));
+
+// --archive <file>
+static cl::opt<std::string> ArchiveFile("archive",
+    cl::desc("Write the generated site as a single tar archive instead of a directory"),
+    cl::value_desc("file"), cl::cat(OptionsCategory));
+
+// --max-memory <MB>
+static cl::opt<unsigned> MaxMemory("max-memory",
+    cl::desc("Spill documentation comments to disk past this memory budget (0: unlimited)"),
+    cl::value_desc("MB"), cl::init(0), cl::cat(OptionsCategory));
+
+// --stats <file>
+static cl::opt<std::string> StatsFile("stats",
+    cl::desc("Write run statistics as JSON to this file"), cl::value_desc("file"),
+    cl::cat(OptionsCategory));
+
+// --records <file>
+static cl::opt<std::string> RecordsFile("records",
+    cl::desc("Write sorted records of documented declarations to this file (see `clong diff`)"),
+    cl::value_desc("file"), cl::cat(OptionsCategory));
+
+// --kinds <kinds>
+static cl::opt<policy::Kinds> DeclKinds("kinds",
+    cl::desc("Declaration kinds to document"),
+    cl::values(
+      clEnumValN(policy::Kinds::all, "all", "All supported declarations (default)"),
+      clEnumValN(policy::Kinds::public_api, "public", "Namespaces, classes and free functions only")),
+    cl::init(policy::Kinds::all), cl::cat(OptionsCategory));
+
+// -j <n>
+static cl::opt<unsigned> Jobs("j",
+    cl::desc("Number of translation units processed concurrently (0: one per core)"),
+    cl::value_desc("n"), cl::init(1), cl::cat(OptionsCategory));
+
+// --history <file>
+static cl::opt<std::string> HistoryFile("history",
+    cl::desc("File recording per translation unit costs, used to schedule them (empty: disabled)"),
+    cl::value_desc("file"), cl::init(".clong-history"), cl::cat(OptionsCategory));
+
+// --jobs-memory <MB>
+static cl::opt<unsigned> JobsMemory("jobs-memory",
+    cl::desc("Do not start translation units whose recorded memory exceeds this budget (0: unlimited)"),
+    cl::value_desc("MB"), cl::init(0), cl::cat(OptionsCategory));
 
 class Consumer : public clang::ASTConsumer {
-  Visitor m_visitor;
+  using clock = std::chrono::steady_clock;
+
+  clang::CompilerInstance& m_ci;
+  Context& m_ctxt;
+  policy::Kinds m_kinds;
+  std::string m_file;
+  // Consumer is created right before parsing
+  clock::time_point m_start;
+
+  private:
+  template <typename Policy>
+  void traverse(clang::ASTContext& ctxt) {
+    Visitor<Policy>(m_ci, m_ctxt).TraverseDecl(ctxt.getTranslationUnitDecl());
+  }
 
   public:
-  Consumer(clang::CompilerInstance& ci, Context& ctxt)
-      : m_visitor(ci, ctxt) {
+  Consumer(clang::CompilerInstance& ci, Context& ctxt, policy::Kinds kinds, llvm::StringRef file)
+      : m_ci(ci), m_ctxt(ctxt), m_kinds(kinds), m_file(file), m_start(clock::now()) {
   }
 
   virtual void HandleTranslationUnit(clang::ASTContext &ctxt) {
+    std::chrono::duration<double> parse = clock::now() - m_start;
+    // Record memory used by this TU, for later scheduling
+    Scheduler::report_memory(ctxt.getASTAllocatedMemory() + ctxt.getSideTableAllocatedMemory());
+    // Printing policy of this TU, used for signatures
+    PrettyPrinter::set_lang_options(ctxt.getLangOpts());
     // Traversing the translation unit decl via a RecursiveASTVisitor
     // will visit all nodes in the AST
-    m_visitor.TraverseDecl(ctxt.getTranslationUnitDecl());
+    clock::time_point start, end;
+    {
+      std::lock_guard<std::mutex> lock(m_ctxt.mutex());
+      // Timed once locked, so waiting for other workers is not counted
+      start = clock::now();
+      switch (m_kinds) {
+        case policy::Kinds::public_api:
+          traverse<policy::Public>(ctxt);
+          break;
+        default:
+          traverse<policy::All>(ctxt);
+      }
+      // Still locked, so declarations of concurrent TUs are never mixed
+      m_ctxt.end_translation_unit();
+      end = clock::now();
+    }
+    std::chrono::duration<double> traverse_time = end - start;
+    m_ctxt.stats().add_tu(m_file, parse.count(), traverse_time.count());
   }
 };
 
@@ -42,12 +144,13 @@ class Action : public clang::ASTFrontendAction {
   }
 
   virtual std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
-      clang::CompilerInstance &ci, llvm::StringRef) override {
-    return std::unique_ptr<clang::ASTConsumer>(new Consumer(ci, m_ctxt));
+      clang::CompilerInstance &ci, llvm::StringRef file) override {
+    return std::unique_ptr<clang::ASTConsumer>(new Consumer(ci, m_ctxt, DeclKinds, file));
   }
 
   virtual void EndSourceFileAction() override {
     // Call hook
+    std::lock_guard<std::mutex> lock(m_ctxt.mutex());
     m_on_end(m_ctxt);
   }
 
@@ -72,17 +175,101 @@ class FrontendActionFactory : public clang::tooling::FrontendActionFactory {
   }
 };
 
+/// Find `compile_commands.json` in `dir`, or in one of its parents if `parents` is true
+static std::string find_compile_commands(llvm::StringRef dir, bool parents) {
+  llvm::SmallString<256> abs_dir(dir);
+  llvm::sys::fs::make_absolute(abs_dir);
+  for (llvm::StringRef d = abs_dir; !d.empty(); d = llvm::sys::path::parent_path(d)) {
+    llvm::SmallString<256> json(d);
+    llvm::sys::path::append(json, "compile_commands.json");
+    if (llvm::sys::fs::exists(json)) {
+      return json.str();
+    }
+    if (!parents) {
+      break;
+    }
+  }
+  return "";
+}
+
+/// Parse arguments and load the compilation database (in case of error, the program is terminated)
+///
+/// Same behavior as clang's `CommonOptionsParser`, except that `compile_commands.json` is loaded
+/// through its binary cache (see `CompilationCache`): with `-p`, the database must be in the build
+/// path, otherwise it is looked up from the directory of the first source and its parents.
+static std::unique_ptr<clang::tooling::CompilationDatabase> load_compilations(
+    int argc, const char** argv) {
+  std::string error;
+  // Arguments after `--` (if any) are used as a fixed compilation database
+  auto fixed = clang::tooling::FixedCompilationDatabase::loadFromCommandLine(argc, argv, error);
+  // Options might have been parsed already (e.g. `run` called more than once)
+  cl::ResetAllOptionOccurrences();
+  cl::HideUnrelatedOptions(OptionsCategory);
+  cl::ParseCommandLineOptions(argc, argv);
+  if (fixed) {
+    return std::move(fixed);
+  }
+  auto from_source = BuildPath.empty();
+  auto dir = from_source
+    ? llvm::sys::path::parent_path(SourcePaths[0]).str() : BuildPath.getValue();
+  auto json = find_compile_commands(dir.empty() ? "." : dir, from_source);
+  std::unique_ptr<clang::tooling::CompilationDatabase> db;
+  if (json.empty()) {
+    error += "No compile_commands.json found in: " + dir + "\n";
+  } else {
+    db = CompilationCache::load_or_build(json, error);
+  }
+  if (!db) {
+    llvm::errs() << "Error while trying to load a compilation database:\n"
+                 << error << "Running without flags.\n";
+    db.reset(new clang::tooling::FixedCompilationDatabase(".", std::vector<std::string>()));
+  }
+  return db;
+}
+
+/// Extra arguments given on the command line
+static clang::tooling::ArgumentsAdjuster extra_args_adjuster() {
+  return clang::tooling::combineAdjusters(
+      clang::tooling::getInsertArgumentAdjuster(
+        std::vector<std::string>(ArgsBefore.begin(), ArgsBefore.end()),
+        clang::tooling::ArgumentInsertPosition::BEGIN),
+      clang::tooling::getInsertArgumentAdjuster(
+        std::vector<std::string>(ArgsAfter.begin(), ArgsAfter.end()),
+        clang::tooling::ArgumentInsertPosition::END));
+}
+
+/// Run the tool on the sources given on the command line
+///
+/// `on_end(ctxt)` is called once, after all TUs have been run (writing the output per TU would
+/// rewrite it as many times as there are TUs).
 template <typename OnEnd>
 int run(int argc, const char** argv, OnEnd on_end) {
-  // CommonOptionsParser constructor will parse arguments and create a
-  // CompilationDatabase.  In case of error it will terminate the program.
-  clang::tooling::CommonOptionsParser OptionsParser(argc, argv, clong::OptionsCategory);
-  clang::tooling::ClangTool Tool(OptionsParser.getCompilations(),
-          OptionsParser.getSourcePathList());
+  auto compilations = load_compilations(argc, argv);
+  // Resolve paths before any tool runs, so they do not depend on the working directory
+  initial_path();
+  for (auto* path : {&OutputDir, &ArchiveFile, &StatsFile, &RecordsFile, &HistoryFile}) {
+    if (!path->empty()) {
+      *path = fs::absolute(path->getValue()).string();
+    }
+  }
+  // Schedule TUs using costs recorded by previous runs
+  clong::Scheduler scheduler(HistoryFile, Jobs, std::size_t(JobsMemory) * 1024 * 1024);
 
   // Run the tool
   clong::Context ctxt;
-  return Tool.run(std::make_unique<clong::FrontendActionFactory>(ctxt, on_end).get());
+  ctxt.set_max_memory(std::size_t(MaxMemory) * 1024 * 1024);
+  std::vector<std::string> sources(SourcePaths.begin(), SourcePaths.end());
+  auto result = scheduler.run(*compilations, sources, extra_args_adjuster(),
+      std::make_unique<clong::FrontendActionFactory>(ctxt).get());
+  on_end(ctxt);
+  // After `on_end`, so written pages are counted
+  if (!StatsFile.empty()) {
+    ctxt.stats().write(StatsFile);
+  }
+  if (!RecordsFile.empty()) {
+    Records::write(RecordsFile, Records::collect(ctxt.root()));
+  }
+  return result;
 }
 
 }
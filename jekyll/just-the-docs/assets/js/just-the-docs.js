@@ -0,0 +1,204 @@
+// Overrides the theme's script: same navigation, but the search uses the index generated by
+// clong (assets/js/search/<c>.json shards) instead of building a lunr index of every page.
+
+// Event handling
+
+function addEvent(el, type, handler) {
+  if (el.attachEvent) el.attachEvent('on' + type, handler); else el.addEventListener(type, handler);
+}
+function removeEvent(el, type, handler) {
+  if (el.detachEvent) el.detachEvent('on' + type, handler); else el.removeEventListener(type, handler);
+}
+
+// Show/hide mobile menu
+
+function toggleNav() {
+  const nav = document.querySelector('.js-main-nav');
+  const auxNav = document.querySelector('.js-aux-nav');
+  const navTrigger = document.querySelector('.js-main-nav-trigger');
+  const search = document.querySelector('.js-search');
+
+  addEvent(navTrigger, 'click', function() {
+    var text = navTrigger.innerText;
+    var textToggle = navTrigger.getAttribute('data-text-toggle');
+
+    nav.classList.toggle('nav-open');
+    auxNav.classList.toggle('nav-open');
+    navTrigger.classList.toggle('nav-open');
+    search.classList.toggle('nav-open');
+    navTrigger.innerText = textToggle;
+    navTrigger.setAttribute('data-text-toggle', text);
+    textToggle = text;
+  });
+}
+
+// Site search
+
+function initSearch() {
+  var searchInput = document.querySelector('.js-search-input');
+  var searchResults = document.querySelector('.js-search-results');
+  if (!searchInput || !searchResults) {
+    return;
+  }
+
+  // Index files are next to this script
+  var jsPath = '';
+  var scripts = document.getElementsByTagName('script');
+  for (var i = 0; i < scripts.length; i++) {
+    if (scripts[i].src && scripts[i].src.match(/just-the-docs\.js$/)) {
+      jsPath = scripts[i].src.replace('just-the-docs.js', '');
+    }
+  }
+
+  // Loaded files (documents table and shards), by path
+  var loaded = {};
+
+  function load(path, callback) {
+    if (path in loaded) {
+      callback(loaded[path]);
+      return;
+    }
+    var request = new XMLHttpRequest();
+    request.open('GET', jsPath + path, true);
+    request.onload = function() {
+      // A missing shard means no term starts with this character
+      loaded[path] = request.status >= 200 && request.status < 400 ? JSON.parse(request.responseText) : null;
+      callback(loaded[path]);
+    };
+    request.onerror = function() {
+      callback(null);
+    };
+    request.send();
+  }
+
+  // Same tokenization as the index: lower-cased runs of alphanumeric characters and `_`
+  function terms(query) {
+    return query.toLowerCase().match(/[a-z0-9_]+/g) || [];
+  }
+
+  function shardOf(term) {
+    return /[a-z0-9]/.test(term[0]) ? term[0] : '_';
+  }
+
+  // Ids of the documents having a term starting with `prefix`
+  function lookup(shard, prefix) {
+    var ids = {};
+    if (!shard) {
+      return ids;
+    }
+    // Terms are sorted: binary search the first one not less than the prefix
+    var lo = 0, hi = shard.terms.length;
+    while (lo < hi) {
+      var mid = (lo + hi) >> 1;
+      if (shard.terms[mid] < prefix) lo = mid + 1; else hi = mid;
+    }
+    for (var t = lo; t < shard.terms.length && shard.terms[t].lastIndexOf(prefix, 0) === 0; t++) {
+      var docs = shard.docs[t];
+      for (var d = 0; d < docs.length; d++) {
+        ids[docs[d]] = true;
+      }
+    }
+    return ids;
+  }
+
+  // Ids of the documents matching all terms of `query`
+  function search(query, callback) {
+    var queryTerms = terms(query);
+    var matches = null;
+    var pending = queryTerms.length;
+    if (!pending) {
+      callback([]);
+      return;
+    }
+    queryTerms.forEach(function(term) {
+      load('search/' + shardOf(term) + '.json', function(shard) {
+        var ids = lookup(shard, term);
+        if (matches === null) {
+          matches = ids;
+        } else {
+          for (var id in matches) {
+            if (!(id in ids)) delete matches[id];
+          }
+        }
+        if (--pending === 0) {
+          callback(Object.keys(matches).map(Number).sort(function(a, b) { return a - b; }));
+        }
+      });
+    });
+  }
+
+  function hideResults() {
+    searchResults.innerHTML = '';
+    searchResults.classList.remove('active');
+  }
+
+  function showResults(store, ids) {
+    hideResults();
+    if (ids.length === 0) {
+      return;
+    }
+    searchResults.classList.add('active');
+    var resultsList = document.createElement('ul');
+    resultsList.classList.add('search-results-list');
+    searchResults.appendChild(resultsList);
+    ids.forEach(function(id) {
+      var doc = store[id];
+      var resultsListItem = document.createElement('li');
+      var resultsLink = document.createElement('a');
+      resultsLink.setAttribute('href', doc.url);
+      resultsLink.innerText = doc.title;
+      resultsListItem.classList.add('search-results-list-item');
+      resultsList.appendChild(resultsListItem);
+      resultsListItem.appendChild(resultsLink);
+    });
+  }
+
+  addEvent(searchInput, 'keyup', function(e) {
+    // When esc key is pressed, hide the results and clear the field
+    if (e.keyCode == 27) {
+      hideResults();
+      searchInput.value = '';
+      return;
+    }
+    var query = searchInput.value;
+    if (query === '') {
+      hideResults();
+      return;
+    }
+    load('search-data.json', function(store) {
+      search(query, function(ids) {
+        // Ignore results of an outdated query
+        if (store && searchInput.value === query) {
+          showResults(store, ids);
+        }
+      });
+    });
+  });
+
+  addEvent(searchInput, 'blur', function() {
+    setTimeout(function() { hideResults(); }, 300);
+  });
+}
+
+function pageFocus() {
+  var mainContent = document.querySelector('.js-main-content');
+  if (mainContent) {
+    mainContent.focus();
+  }
+}
+
+// Document ready
+
+function ready(fn) {
+  if (document.readyState != 'loading') {
+    fn();
+  } else {
+    document.addEventListener('DOMContentLoaded', fn);
+  }
+}
+
+ready(function() {
+  toggleNav();
+  pageFocus();
+  initSearch();
+});
@@ -6,12 +6,26 @@
 #include <clong/run.hpp>
 
 int main(int argc, const char** argv) {
-  // Hook called whenever the tool as finished running
+  // `clong diff <old> <new>`: compare records (see `--records`) of two runs
+  if (argc == 4 && std::string(argv[1]) == "diff") {
+    auto changes = clong::Records::diff(argv[2], argv[3], std::cout);
+    if (changes.error.size()) {
+      std::cerr << "clong diff: " << changes.error << "\n";
+      return 2;
+    }
+    return changes.added || changes.removed || changes.changed;
+  }
+
+  // Hook called once the tool has run on all sources
   return clong::run(argc, argv, [](clong::Context& ctxt) {
     // Pretty print current parsed nodes
-    std::cout << clong::PrettyPrinter::pprint(&ctxt.root());
+    clong::PrettyPrinter::pprint(std::cout, &ctxt.root());
 
     // Output to jekyll format
-    clong::jekyll::JustTheDocs::write(clong::OutputDir, ctxt);
+    if (clong::ArchiveFile.empty()) {
+      clong::jekyll::JustTheDocs::write(clong::OutputDir, ctxt);
+    } else {
+      clong::jekyll::JustTheDocs::write_archive(clong::ArchiveFile, ctxt);
+    }
   });
 }
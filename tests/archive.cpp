@@ -0,0 +1,101 @@
+#include "lib/clong_test.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// A tar header block
+struct TarHeader {
+  std::string name;
+  char type;
+  std::string size;
+  std::string mtime;
+  bool checksum_ok;
+
+  TarHeader(const char* h) {
+    name = std::string(h, strnlen(h, 100));
+    type = h[156];
+    size = std::string(h + 124, 11);
+    mtime = std::string(h + 136, 11);
+    // Checksum is computed with its own field filled with spaces
+    unsigned long checksum = 0;
+    for (int i = 0; i < 512; ++i) {
+      checksum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(h[i]);
+    }
+    checksum_ok = std::strtoul(h + 148, nullptr, 8) == checksum;
+  }
+};
+
+TEST(Test, Archive) {
+  clong::test_temp_file archive("test.tar", "");
+  auto long_path = "refs/" + std::string(120, 'a') + ".md";
+  {
+    clong::jekyll::ArchiveOutput out(archive.path());
+    out.directory("refs/");
+    out.file("refs/a.md", "hello");
+    out.file(long_path, "x");
+    out.finish();
+  }
+
+  auto tar = clong::test_read_file(archive.path());
+  ASSERT_EQ(tar.size() % 512, 0u);
+  std::size_t offset = 0;
+  auto next = [&](std::size_t content_size = 0) {
+    TarHeader h(tar.data() + offset);
+    offset += 512 + (content_size + 511) / 512 * 512;
+    EXPECT_TRUE(h.checksum_ok) << h.name;
+    // Fixed mtime, so archives are reproducible
+    EXPECT_EQ(h.mtime, "00000000000") << h.name;
+    return h;
+  };
+
+  auto dir = next();
+  ASSERT_EQ(dir.name, "refs/");
+  ASSERT_EQ(dir.type, '5');
+
+  auto a = next(5);
+  ASSERT_EQ(a.name, "refs/a.md");
+  ASSERT_EQ(a.type, '0');
+  ASSERT_EQ(a.size, "00000000005");
+  ASSERT_EQ(tar.substr(offset - 512, 5), "hello");
+
+  // Long names are stored in a pax extended header
+  // Record length includes its own (3 digits here) length
+  auto record = " path=" + long_path + "\n";
+  record = std::to_string(record.size() + 3) + record;
+  auto pax_offset = offset;
+  auto pax = next(record.size());
+  ASSERT_EQ(pax.type, 'x');
+  ASSERT_EQ(tar.substr(pax_offset + 512, record.size()), record);
+  auto l = next(1);
+  ASSERT_EQ(l.name, long_path.substr(0, 100));
+  ASSERT_EQ(l.type, '0');
+
+  // End of archive
+  ASSERT_EQ(tar.size(), offset + 2 * 512);
+  ASSERT_EQ(tar.substr(offset), std::string(2 * 512, '\0'));
+}
+
+TEST(Test, ArchiveCopySorted) {
+  auto src = clong::fs::temp_directory_path() / "clong_archive_copy";
+  clong::fs::remove_all(src);
+  clong::fs::create_directories(src / "d");
+  for (auto name : {"b.md", "d/c.md", "a.md"}) {
+    std::ofstream(src / name) << name;
+  }
+  clong::test_temp_file archive("test.tar", "");
+  {
+    clong::jekyll::ArchiveOutput out(archive.path());
+    out.copy(src);
+    out.finish();
+  }
+  clong::fs::remove_all(src);
+
+  // Same order whatever the file system order is
+  auto tar = clong::test_read_file(archive.path());
+  std::vector<std::string> names;
+  for (std::size_t offset = 0; offset + 2 * 512 < tar.size();) {
+    TarHeader h(tar.data() + offset);
+    names.push_back(h.name);
+    offset += 512 + (std::strtoul(h.size.c_str(), nullptr, 8) + 511) / 512 * 512;
+  }
+  ASSERT_EQ(names, (std::vector<std::string>{"a.md", "b.md", "d/", "d/c.md"}));
+}
@@ -0,0 +1,57 @@
+#include "lib/clong_test.hpp"
+#include <clong/CompilationCache.hpp>
+#include <algorithm>
+
+TEST(Test, CompilationCache) {
+  auto dir = clong::fs::temp_directory_path();
+  auto file = (dir / "clong_cache_test.cpp").generic_string();
+  clong::test_temp_file json("clong_cache_test.json",
+    "[{\"directory\": \"" + dir.generic_string() + "\", "
+    "\"command\": \"c++ -DCACHED -c clong_cache_test.cpp\", "
+    "\"file\": \"clong_cache_test.cpp\"}]");
+  clong::test_temp_file cache("clong_cache_test.json.clong-cache", "");
+
+  std::string error;
+  auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+      json.path(), error, clang::tooling::JSONCommandLineSyntax::AutoDetect);
+  ASSERT_TRUE(db) << error;
+  ASSERT_TRUE(clong::CompilationCache::build(cache.path(), *db, 1, 2));
+
+  // Looked up by absolute path, so relative paths work from any directory
+  auto loaded = clong::CompilationCache::load(cache.path(), 1, 2);
+  ASSERT_TRUE(loaded);
+  auto relative = clong::fs::relative(file, clong::fs::current_path()).string();
+  auto commands = loaded->getCompileCommands(relative);
+  ASSERT_EQ(commands.size(), 1u);
+  ASSERT_EQ(commands[0].Directory, dir.generic_string());
+  auto const& args = commands[0].CommandLine;
+  ASSERT_NE(std::find(args.begin(), args.end(), "-DCACHED"), args.end());
+  ASSERT_TRUE(loaded->getCompileCommands(file + ".other").empty());
+
+  // Stale when the JSON size or modification time changed
+  ASSERT_FALSE(clong::CompilationCache::load(cache.path(), 3, 2));
+  ASSERT_FALSE(clong::CompilationCache::load(cache.path(), 1, 3));
+}
+
+TEST(Test, CompilationCacheTruncated) {
+  auto dir = clong::fs::temp_directory_path();
+  clong::test_temp_file json("clong_cache_test.json",
+    "[{\"directory\": \"" + dir.generic_string() + "\", "
+    "\"command\": \"c++ -c clong_cache_test.cpp\", "
+    "\"file\": \"clong_cache_test.cpp\"}]");
+  clong::test_temp_file cache("clong_cache_test.json.clong-cache", "");
+
+  std::string error;
+  auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+      json.path(), error, clang::tooling::JSONCommandLineSyntax::AutoDetect);
+  ASSERT_TRUE(db) << error;
+  ASSERT_TRUE(clong::CompilationCache::build(cache.path(), *db, 1, 2));
+
+  // Valid header, but strings are cut
+  auto content = clong::test_read_file(cache.path());
+  {
+    std::ofstream o(cache.path(), std::ofstream::out | std::ofstream::binary);
+    o.write(content.data(), content.size() - 8);
+  }
+  ASSERT_FALSE(clong::CompilationCache::load(cache.path(), 1, 2));
+}
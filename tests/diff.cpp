@@ -0,0 +1,91 @@
+#include "lib/clong_test.hpp"
+#include <sstream>
+
+TEST(Test, Diff) {
+  clong::test_temp_file old_records("old.records",
+    "a\tFunction\t1\t1\tvoid a()\n"
+    "b\tFunction\t2\t2\tvoid b()\n"
+    "c\tFunction\t3\t3\tvoid c()\n"
+    "d\tFunction\t4\t4\tvoid d()\n"
+    );
+  clong::test_temp_file new_records("new.records",
+    "b\tFunction\t2\t5\tvoid b()\n"
+    "c\tFunction\t6\t3\tvoid c(int)\n"
+    "d\tFunction\t4\t4\tvoid d()\n"
+    "e\tFunction\t7\t7\tvoid e()\n"
+    );
+
+  std::ostringstream report;
+  auto changes = clong::Records::diff(old_records.path(), new_records.path(), report);
+  ASSERT_EQ(changes.added, 1);
+  ASSERT_EQ(changes.removed, 1);
+  ASSERT_EQ(changes.changed, 2);
+  ASSERT_EQ(report.str(),
+    "- Function a\tvoid a()\n"
+    "~ Function b (comment)\tvoid b()\n"
+    "~ Function c (signature, was: void c())\tvoid c(int)\n"
+    "+ Function e\tvoid e()\n"
+    "1 added, 1 removed, 2 changed\n");
+}
+
+TEST(Test, DiffBlankLines) {
+  clong::test_temp_file old_records("old.records",
+    "a\tFunction\t1\t1\tvoid a()\n"
+    "\n"
+    );
+  clong::test_temp_file new_records("new.records",
+    "\n"
+    "a\tFunction\t1\t2\tvoid a()\n"
+    "\n"
+    );
+
+  std::ostringstream report;
+  auto changes = clong::Records::diff(old_records.path(), new_records.path(), report);
+  ASSERT_EQ(changes.error, "");
+  ASSERT_EQ(changes.changed, 1);
+}
+
+TEST(Test, DiffErrors) {
+  clong::test_temp_file records("old.records",
+    "a\tFunction\t1\t1\tvoid a()\n"
+    );
+  clong::test_temp_file malformed("new.records",
+    "a\tFunction\t1\t1\tvoid a()\n"
+    "b\tFunction\tnot a hash\n"
+    );
+  clong::test_temp_file unsorted("unsorted.records",
+    "b\tFunction\t1\t1\tvoid b()\n"
+    "a\tFunction\t1\t1\tvoid a()\n"
+    );
+
+  std::ostringstream report;
+  auto changes = clong::Records::diff(records.path(), malformed.path(), report);
+  ASSERT_EQ(changes.error, malformed.path() + ":2: malformed record");
+  changes = clong::Records::diff(records.path(), unsorted.path(), report);
+  ASSERT_EQ(changes.error, unsorted.path() + ":2: records are not sorted");
+  changes = clong::Records::diff(records.path(), records.path() + ".missing", report);
+  ASSERT_EQ(changes.error, "unable to open " + records.path() + ".missing");
+}
+
+TEST(Test, RecordsDuplicates) {
+  // Same declaration registered by two TUs, documented in only one of them
+  clong::RootNode root;
+  clong::Node undocumented, documented, other;
+  for (auto* node : {&undocumented, &documented, &other}) {
+    node->parent = &root;
+    node->kind = "Function";
+    node->decl = nullptr;
+    root.children.push_back(node);
+  }
+  undocumented.name = undocumented.qualified_name = documented.name = documented.qualified_name = "f";
+  undocumented.signature = documented.signature = "void f()";
+  documented.comment = " Documented\n";
+  other.name = other.qualified_name = "f";
+  other.signature = "void f(int)";
+
+  auto records = clong::Records::collect(root);
+  ASSERT_EQ(records.size(), 2u);
+  ASSERT_EQ(records[0].signature, "void f()");
+  ASSERT_EQ(records[0].comment_hash, clong::hash::fnv1a(" Documented\n"));
+  ASSERT_EQ(records[1].signature, "void f(int)");
+}
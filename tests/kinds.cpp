@@ -0,0 +1,29 @@
+#include "lib/clong_test.hpp"
+
+TEST(Test, KindsPublic) {
+  clong::test_temp_file input("test.cpp",
+    "/// Is documented\n"
+    "struct documented {\n"
+    "  /// Is a method\n"
+    "  void method();\n"
+    "};\n"
+    "/// Is a variable\n"
+    "int variable;\n"
+    "/// Is a free function\n"
+    "void function() {\n"
+    "  /// Is local\n"
+    "  struct local {};\n"
+    "}\n"
+    );
+
+  clong::test({input.path(), "--kinds=public"}, [](clong::Context& ctxt) {
+    auto root = ctxt.root();
+    ASSERT_EQ(root.children.size(), 2);
+    auto documented = root.children[0];
+    auto function = root.children[1];
+    ASSERT_EQ(clong::ident(documented->decl), "documented");
+    ASSERT_EQ(documented->children.size(), 0);
+    ASSERT_EQ(clong::ident(function->decl), "function");
+    ASSERT_EQ(function->children.size(), 0);
+  });
+}
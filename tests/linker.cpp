@@ -0,0 +1,47 @@
+#include "lib/clong_test.hpp"
+
+static std::string link(clong::jekyll::Linker const& linker, std::string const& text,
+    std::string const& self = "") {
+  std::string linked;
+  linker.link(text, self,
+      [&](char c) { linked += c; },
+      [&](std::string const& symbol, std::string const& url) {
+        linked += "[" + symbol + "](" + url + ")";
+      });
+  return linked;
+}
+
+TEST(Test, LinkerQualified) {
+  clong::jekyll::Linker linker;
+  linker.add("a::f", "f", "/a.f/");
+  linker.add("b::f", "f", "/b.f/");
+  linker.add("g", "g", "/g/");
+  linker.add("a::b::h", "h", "/a.b.h/");
+
+  // Qualified names are always linked, names only when they are not ambiguous
+  ASSERT_EQ(link(linker, "a::f(b::f, f, g, x::g)"), "[a::f](/a.f/)([b::f](/b.f/), f, [g](/g/), x::g)");
+  // Partially qualified names only when their qualifiers match
+  ASSERT_EQ(link(linker, "h b::h a::b::h x::h ab::h"), "[h](/a.b.h/) [b::h](/a.b.h/) [a::b::h](/a.b.h/) x::h ab::h");
+  // Only whole identifiers are linked
+  ASSERT_EQ(link(linker, "g_ gg _g"), "g_ gg _g");
+}
+
+TEST(Test, LinkerAmbiguous) {
+  clong::jekyll::Linker linker;
+  // Overloads have a page each
+  linker.add("a::f", "f", "/a.f-1/");
+  linker.add("a::f", "f", "/a.f-2/");
+  // Same page added twice is not ambiguous
+  linker.add("a::g", "g", "/a.g/");
+  linker.add("a::g", "g", "/a.g/");
+
+  ASSERT_EQ(link(linker, "a::f f a::g g"), "a::f f [a::g](/a.g/) [g](/a.g/)");
+}
+
+TEST(Test, LinkerSelf) {
+  clong::jekyll::Linker linker;
+  linker.add("a::f", "f", "/a.f/");
+  linker.add("a::g", "g", "/a.g/");
+
+  ASSERT_EQ(link(linker, "void f(g)", "/a.f/"), "void f([g](/a.g/))");
+}
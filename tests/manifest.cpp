@@ -0,0 +1,45 @@
+#include "lib/clong_test.hpp"
+
+TEST(Test, Manifest) {
+  auto dst = clong::fs::temp_directory_path() / "clong_manifest_test";
+  clong::fs::remove_all(dst);
+  clong::fs::create_directories(dst);
+  auto write = [&](std::string const& page, std::string const& content) {
+    clong::fs::ofstream o(dst / page);
+    o << content;
+  };
+
+  {
+    clong::jekyll::Manifest manifest(dst);
+    ASSERT_FALSE(manifest.loaded());
+    ASSERT_TRUE(manifest.update("a.md", "a"));
+    write("a.md", "a");
+    ASSERT_TRUE(manifest.update("b.md", "b"));
+    write("b.md", "b");
+    manifest.save();
+  }
+
+  {
+    clong::jekyll::Manifest manifest(dst);
+    ASSERT_TRUE(manifest.loaded());
+    // Unchanged pages are skipped, changed ones are not
+    ASSERT_FALSE(manifest.update("a.md", "a"));
+    ASSERT_TRUE(manifest.update("c.md", "c"));
+    write("c.md", "c");
+    // `b.md` has not been generated again
+    manifest.save();
+  }
+  ASSERT_TRUE(clong::fs::exists(dst / "a.md"));
+  ASSERT_FALSE(clong::fs::exists(dst / "b.md"));
+  ASSERT_TRUE(clong::fs::exists(dst / "c.md"));
+
+  {
+    clong::jekyll::Manifest manifest(dst);
+    ASSERT_TRUE(manifest.update("a.md", "changed"));
+    // Pages removed by hand are written again
+    clong::fs::remove(dst / "c.md");
+    ASSERT_TRUE(manifest.update("c.md", "c"));
+  }
+
+  clong::fs::remove_all(dst);
+}
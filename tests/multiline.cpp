@@ -11,5 +11,25 @@ TEST(Test, Multiline) {
   clong::test({input.path()}, [](clong::Context& ctxt) {
     auto test = *ctxt.functions().begin();
     ASSERT_EQ(test->comment, " This is a\n multiline\n comment!\n");
+    ASSERT_EQ(test->signature, "void test()");
+  });
+}
+
+TEST(Test, MultilineSignature) {
+  clong::test_temp_file input("test.cpp",
+    "/// A namespace\n"
+    "namespace ns {\n"
+    "/// An enum\n"
+    "enum E { a, b };\n"
+    "}\n"
+    );
+
+  clong::test({input.path()}, [](clong::Context& ctxt) {
+    auto root = ctxt.root();
+    ASSERT_EQ(root.children.size(), 1u);
+    auto ns = root.children[0];
+    ASSERT_EQ(ns->signature, "namespace ns");
+    ASSERT_EQ(ns->children.size(), 1u);
+    ASSERT_EQ(ns->children[0]->signature, "enum E");
   });
 }
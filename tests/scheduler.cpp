@@ -0,0 +1,37 @@
+#include "lib/clong_test.hpp"
+#include <clong/Scheduler.hpp>
+
+TEST(Test, SchedulerHistory) {
+  clong::test_temp_file history("test.history", "");
+
+  {
+    clong::History h(history.path());
+    h.update("/a b.cpp", {1.5, 100});
+    h.update("/c.cpp", {0.25, 200});
+    h.save();
+  }
+
+  clong::History h(history.path());
+  auto* a = h.find("/a b.cpp");
+  ASSERT_TRUE(a);
+  ASSERT_EQ(a->seconds, 1.5);
+  ASSERT_EQ(a->memory, 100u);
+  auto* c = h.find("/c.cpp");
+  ASSERT_TRUE(c);
+  ASSERT_EQ(c->seconds, 0.25);
+  ASSERT_EQ(c->memory, 200u);
+  ASSERT_FALSE(h.find("/d.cpp"));
+}
+
+TEST(Test, SchedulerLongestFirst) {
+  clong::test_temp_file history("test.history",
+    "1 0 /short.cpp\n"
+    "3 0 /long.cpp\n"
+    "2 0 /medium.cpp\n"
+    );
+
+  clong::Scheduler scheduler(history.path(), 1, 0);
+  auto ordered = scheduler.schedule({"/short.cpp", "/new.cpp", "/long.cpp", "/medium.cpp"});
+  // Unknown TUs first, as they might be the longest ones
+  ASSERT_EQ(ordered, (std::vector<std::string>{"/new.cpp", "/long.cpp", "/medium.cpp", "/short.cpp"}));
+}
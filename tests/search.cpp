@@ -0,0 +1,40 @@
+#include "lib/clong_test.hpp"
+#include <map>
+
+// Keeps written files in memory
+class MemoryOutput : public clong::jekyll::Output {
+  public:
+  std::map<std::string, std::string> files;
+
+  virtual void copy(clong::fs::path const&) override {}
+  virtual void directory(std::string const&) override {}
+  virtual bool file(std::string const& path, std::string const& content) override {
+    files[path] = content;
+    return true;
+  }
+  virtual void finish() override {}
+};
+
+TEST(Test, SearchIndex) {
+  clong::jekyll::SearchIndex index;
+  index.add("foo", "/refs/function/foo/", " Does foo_bar,\n  twice!\n");
+  index.add("Bar", "/refs/class/bar/", " Uses FOO\n");
+
+  MemoryOutput out;
+  index.write(out, "assets/js/");
+  ASSERT_EQ(out.files["assets/js/search-data.json"],
+    "{\n"
+    "\"0\": {\"id\": \"0\", \"title\": \"foo\", "
+    "\"url\": \"/refs/function/foo/\", \"relUrl\": \"/refs/function/foo/\"},\n"
+    "\"1\": {\"id\": \"1\", \"title\": \"Bar\", "
+    "\"url\": \"/refs/class/bar/\", \"relUrl\": \"/refs/class/bar/\"}\n"
+    "}\n");
+  // Terms are lower-cased, and snake_case parts are indexed too
+  ASSERT_EQ(out.files["assets/js/search/f.json"],
+    "{\"terms\": [\"foo\",\"foo_bar\"],\n\"docs\": [[0,1],[0]]}\n");
+  ASSERT_EQ(out.files["assets/js/search/b.json"],
+    "{\"terms\": [\"bar\"],\n\"docs\": [[0,1]]}\n");
+  ASSERT_EQ(out.files["assets/js/search/t.json"],
+    "{\"terms\": [\"twice\"],\n\"docs\": [[0]]}\n");
+  ASSERT_EQ(out.files.count("assets/js/search/_.json"), 0u);
+}
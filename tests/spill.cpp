@@ -0,0 +1,63 @@
+#include "lib/clong_test.hpp"
+
+TEST(Test, Spill) {
+  clong::test_temp_file input("test.cpp",
+    "/// This is a\n"
+    "/// spilled comment!\n"
+    "void test();\n"
+    );
+
+  clong::test({input.path()}, [](clong::Context& ctxt) {
+    ctxt.spill();
+    auto test = *ctxt.functions().begin();
+    ASSERT_TRUE(test->comment.empty());
+    ASSERT_EQ(test->comment_text(), " This is a\n spilled comment!\n");
+  });
+}
+
+TEST(Test, SpillOverBudget) {
+  auto ast = clang::tooling::buildASTFromCode(
+    "/// First spilled comment\n"
+    "void first();\n"
+    "/// Second spilled comment\n"
+    "void second();\n"
+    );
+  // Not used by the visitor, only required to build it
+  clang::CompilerInstance ci;
+  clong::PrettyPrinter::set_lang_options(ast->getASTContext().getLangOpts());
+  clong::Context ctxt;
+  // Any registered node is over budget
+  ctxt.set_max_memory(1);
+  clong::Visitor<>(ci, ctxt).TraverseDecl(ast->getASTContext().getTranslationUnitDecl());
+
+  ASSERT_EQ(ctxt.functions().size(), 2u);
+  for (auto const* f : ctxt.functions()) {
+    ASSERT_TRUE(f->segment);
+    ASSERT_TRUE(f->comment.empty());
+    ASSERT_EQ(f->comment_text(), f->name == "first"
+      ? " First spilled comment\n" : " Second spilled comment\n");
+  }
+}
+
+TEST(Test, EndTranslationUnit) {
+  auto ast = clang::tooling::buildASTFromCode(
+    "/// Documented\n"
+    "void documented();\n"
+    );
+  clang::CompilerInstance ci;
+  clong::PrettyPrinter::set_lang_options(ast->getASTContext().getLangOpts());
+  clong::Context ctxt;
+  clong::Visitor<>(ci, ctxt).TraverseDecl(ast->getASTContext().getTranslationUnitDecl());
+  auto const* documented = *ctxt.functions().begin();
+  ASSERT_TRUE(ctxt.has_been_visited(documented->decl));
+  auto memory = ctxt.memory();
+
+  // Declarations are forgotten (their AST is about to be freed), nodes are kept
+  ctxt.end_translation_unit();
+  ASSERT_FALSE(ctxt.has_been_visited(documented->decl));
+  ASSERT_FALSE(ctxt.has_registered_node(documented->decl));
+  ASSERT_LT(ctxt.memory(), memory);
+  ASSERT_EQ(ctxt.functions().size(), 1u);
+  ASSERT_EQ(documented->name, "documented");
+  ASSERT_EQ(documented->comment_text(), " Documented\n");
+}
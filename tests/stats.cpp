@@ -0,0 +1,19 @@
+#include "lib/clong_test.hpp"
+
+TEST(Test, Stats) {
+  clong::test_temp_file input("test.cpp",
+    "struct not_documented {\n"
+    "  /// Is documented\n"
+    "  void i_am_documented();\n"
+    "  void i_am_not_documented();\n"
+    "};\n"
+    );
+
+  clong::test({input.path()}, [](clong::Context& ctxt) {
+    auto& stats = ctxt.stats();
+    ASSERT_EQ(stats.visited[clong::Stats::function_decl].load(), 2u);
+    ASSERT_EQ(stats.registered.load(), 2u);
+    ASSERT_EQ(stats.auto_registered_parents.load(), 1u);
+    ASSERT_EQ(stats.comment_bytes.load(), std::string(" Is documented\n").size());
+  });
+}